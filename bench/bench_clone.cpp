@@ -0,0 +1,89 @@
+// Instance start-up benchmark: compares making a ready-to-run interpreter by
+// constructing it and loading the .bin with cloning one loaded template, and
+// reports microseconds per instance for each.
+//
+// Usage: masm_bench_clone [file.masm|file.bin] [RAM size]
+// Without arguments examples/malloc.masm is used with 64 KiB of RAM.
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#if __has_include(<filesystem>)
+    #include <filesystem>
+    namespace fs = std::filesystem;
+#else
+    #include <experimental/filesystem>
+    namespace fs = std::experimental::filesystem;
+#endif
+
+#include "microasm_compiler.h"
+#include "microasm_interpreter.h"
+
+#ifndef MASM_EXAMPLES_DIR
+#define MASM_EXAMPLES_DIR "examples"
+#endif
+
+static std::string compileToTemp(const std::string& source) {
+    std::ifstream file(source);
+    if (!file) throw std::runtime_error("Could not open source file: " + source);
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+
+    fs::path binary = fs::temp_directory_path() / (fs::path(source).stem().string() + ".bench.bin");
+    Compiler compiler;
+    compiler.parse(buffer.str());
+    compiler.compile(binary.string());
+    return binary.string();
+}
+
+// Best microseconds per instance of `make` over a few rounds
+template <typename F>
+static double measure(F make) {
+    const int instances = 2000;
+    double best = 1e30;
+    for (int round = 0; round < 3; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < instances; i++) {
+            std::unique_ptr<Interpreter> interpreter = make();
+            // Write one word like a running program would, so the clone has
+            // to copy a page
+            interpreter->writeRamInt(0, i);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, seconds * 1e6 / instances);
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    std::string program = argc > 1 ? argv[1] : MASM_EXAMPLES_DIR "/malloc.masm";
+    int ramSize = 65536;
+    try {
+        if (argc > 2) ramSize = parseRamSize(argv[2]);
+        std::string binary = fs::path(program).extension() == ".masm" ? compileToTemp(program) : program;
+
+        Interpreter loaded(ramSize);
+        loaded.load(binary);
+        double load = measure([&] {
+            std::unique_ptr<Interpreter> interpreter(new Interpreter(ramSize));
+            interpreter->load(binary);
+            return interpreter;
+        });
+        double clone = measure([&] { return loaded.clone(); });
+
+        std::cout << std::left << std::setw(24) << "program" << std::right << std::setw(12) << "RAM"
+                  << std::setw(16) << "load us" << std::setw(16) << "clone us" << std::setw(10) << "speedup" << "\n";
+        std::cout << std::left << std::setw(24) << fs::path(program).filename().string() << std::right
+                  << std::setw(12) << ramSize << std::fixed << std::setprecision(2) << std::setw(16) << load
+                  << std::setw(16) << clone << std::setw(9) << std::setprecision(1) << load / clone << "x\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Operand decoding microbenchmark: reads a stream of typed operands with the
+// old byte-by-byte decoder and with readOperandValue(), the single load plus
+// width mask nextRawOperand() uses, and reports operands/sec for each.
+//
+// Usage: masm_bench_decode [operand count]
+// The stream mixes 1-, 2-, 3- and 4-byte immediates in random order.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "microasm_interpreter.h"
+
+static int operandSize(uint8_t type) {
+    int size = type >> 4;
+    if (size == 0)
+        size = (type & 0xF) == 6 ? 3 : 4;
+    return size;
+}
+
+// The decoder before single-load decoding: two size checks and one shift per
+// byte.
+static long long legacyOperand(const std::vector<uint8_t>& code, size_t codeSize, size_t& ip) {
+    int size = ip < codeSize ? operandSize(code[ip]) : 0;
+    if (ip + 1 + size > codeSize)
+        throw std::runtime_error("Unexpected end of bytecode reading typed operand");
+    ip++;
+    if (ip + size > codeSize)
+        throw std::runtime_error("Unexpected end of bytecode reading operand value");
+    long long value = code[ip];
+    if (size >= 2) value += (code[ip + 1] << 8);
+    if (size >= 3) value += (code[ip + 2] << 16);
+    // The top byte is shifted unsigned so it cannot overflow int, and the
+    // result is sign-extended like a 4 byte operand
+    if (size >= 4) value += (int32_t)((uint32_t)code[ip + 3] << 24);
+    if (size != 4)
+        value &= (1 << (8 * size)) - 1;
+    ip += size;
+    return value;
+}
+
+static long long singleLoadOperand(const std::vector<uint8_t>& code, size_t codeSize, size_t& ip) {
+    int size = operandSize(code[ip]);
+    if (ip + 1 + size > codeSize)
+        throw std::runtime_error("Unexpected end of bytecode reading typed operand");
+    ip++;
+    long long value = readOperandValue(&code[ip], size);
+    ip += size;
+    return value;
+}
+
+template <typename Decoder>
+static double measure(const std::vector<uint8_t>& code, size_t codeSize, size_t count,
+                      Decoder decode, long long& checksum) {
+    double best = 0;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        long long sum = 0;
+        size_t ip = 0;
+        while (ip < codeSize)
+            sum += decode(code, codeSize, ip);
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double rate = seconds > 0 ? count / seconds : 0;
+        if (rate > best) best = rate;
+        checksum = sum;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::mt19937 rng(42);
+    std::vector<uint8_t> code;
+    code.reserve(count * 5 + BYTECODE_PADDING);
+    for (size_t i = 0; i < count; i++) {
+        int size = 1 + rng() % 4;
+        code.push_back((uint8_t)OperandType::IMMEDIATE | (size << 4));
+        uint32_t value = rng();
+        for (int b = 0; b < size; b++)
+            code.push_back((value >> (8 * b)) & 0xFF);
+    }
+    size_t codeSize = code.size();
+    code.resize(codeSize + BYTECODE_PADDING, 0);
+
+    long long legacySum = 0, singleSum = 0;
+    double legacy = measure(code, codeSize, count, legacyOperand, legacySum);
+    double single = measure(code, codeSize, count, singleLoadOperand, singleSum);
+    if (legacySum != singleSum) {
+        std::cerr << "Decoders disagree: " << legacySum << " vs " << singleSum << "\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(0)
+              << std::left << std::setw(16) << "decoder" << std::right << std::setw(16) << "operands/s" << "\n"
+              << std::left << std::setw(16) << "byte-by-byte" << std::right << std::setw(16) << legacy << "\n"
+              << std::left << std::setw(16) << "single load" << std::right << std::setw(16) << single << "\n"
+              << std::setprecision(2) << "speedup " << (legacy > 0 ? single / legacy : 0) << "x\n";
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Execute-loop benchmark: runs each program through the release and the
+// debug instantiation of Interpreter::execute() and reports instructions/sec.
+//
+// Usage: masm_bench [file.masm|file.bin ...]
+// Without arguments every program in examples/ is measured.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if __has_include(<filesystem>)
+    #include <filesystem>
+    namespace fs = std::filesystem;
+#else
+    #include <experimental/filesystem>
+    namespace fs = std::experimental::filesystem;
+#endif
+
+#include "microasm_compiler.h"
+#include "microasm_interpreter.h"
+
+#ifndef MASM_EXAMPLES_DIR
+#define MASM_EXAMPLES_DIR "examples"
+#endif
+
+// Swallows program output so it does not end up in the measurements
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct RunResult {
+    bool ok = false;
+    uint64_t instructions = 0; // per run
+    double seconds = 0;        // total over all runs
+    int runs = 0;
+};
+
+static RunResult measure(const std::string& binary, bool debug, double minSeconds) {
+    RunResult result;
+    NullBuffer nullBuffer;
+    std::streambuf* oldOut = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldErr = std::cerr.rdbuf(&nullBuffer);
+    std::streambuf* oldIn = std::cin.rdbuf();
+
+    try {
+        while (result.seconds < minSeconds && result.runs < 100000) {
+            // The debugger reads its commands from stdin; "continue" lets the
+            // debug loop run to completion without stopping.
+            std::istringstream commands("c\n");
+            std::cin.rdbuf(commands.rdbuf());
+
+            Interpreter interpreter(MEMORY_SIZE, {}, debug);
+            interpreter.load(binary);
+            auto start = std::chrono::steady_clock::now();
+            interpreter.execute();
+            auto end = std::chrono::steady_clock::now();
+
+            std::cin.rdbuf(oldIn);
+            result.seconds += std::chrono::duration<double>(end - start).count();
+            result.instructions = interpreter.getInstructionCount();
+            result.runs++;
+        }
+        result.ok = true;
+    } catch (const std::exception&) {
+        result.ok = false;
+    }
+
+    std::cin.rdbuf(oldIn);
+    std::cout.rdbuf(oldOut);
+    std::cerr.rdbuf(oldErr);
+    return result;
+}
+
+static std::string compileToTemp(const std::string& source) {
+    std::ifstream file(source);
+    if (!file) throw std::runtime_error("Could not open source file: " + source);
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+
+    fs::path binary = fs::temp_directory_path() / (fs::path(source).stem().string() + ".bench.bin");
+    Compiler compiler;
+    compiler.parse(buffer.str());
+    compiler.compile(binary.string());
+    return binary.string();
+}
+
+static double perSecond(const RunResult& r) {
+    return r.seconds > 0 ? (double)r.instructions * r.runs / r.seconds : 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> programs;
+    for (int i = 1; i < argc; ++i) programs.push_back(argv[i]);
+    if (programs.empty()) {
+        for (const auto& entry : fs::directory_iterator(MASM_EXAMPLES_DIR)) {
+            if (entry.path().extension() == ".masm") programs.push_back(entry.path().string());
+        }
+        std::sort(programs.begin(), programs.end());
+    }
+
+    std::cout << std::left << std::setw(24) << "program" << std::right
+              << std::setw(12) << "instrs/run"
+              << std::setw(16) << "release ips"
+              << std::setw(16) << "debug ips"
+              << std::setw(10) << "speedup" << "\n";
+
+    for (const auto& program : programs) {
+        std::string name = fs::path(program).filename().string();
+        std::string binary;
+        try {
+            binary = fs::path(program).extension() == ".masm" ? compileToTemp(program) : program;
+        } catch (const std::exception& e) {
+            std::cout << std::setfill(' ') << std::left << std::setw(24) << name << " compile failed: " << e.what() << "\n";
+            continue;
+        }
+
+        RunResult release = measure(binary, false, 0.5);
+        RunResult debug = measure(binary, true, 0.5);
+        if (!release.ok || !debug.ok) {
+            std::cout << std::setfill(' ') << std::left << std::setw(24) << name << " runtime error, skipped\n";
+            continue;
+        }
+
+        // The debug loop changes the fill character of std::cout
+        std::cout << std::setfill(' ');
+        double releaseIps = perSecond(release);
+        double debugIps = perSecond(debug);
+        std::cout << std::left << std::setw(24) << name << std::right
+                  << std::setw(12) << release.instructions
+                  << std::setw(16) << std::fixed << std::setprecision(0) << releaseIps
+                  << std::setw(16) << debugIps
+                  << std::setw(9) << std::setprecision(1) << (debugIps > 0 ? releaseIps / debugIps : 0) << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Heap allocation-churn benchmark: drives the old first-fit chunk list and
+// the size-class Heap behind MALLOC/FREE through the same allocation
+// patterns and reports MALLOC+FREE pairs/sec for each.
+//
+// Usage: masm_bench_heap [live allocations]
+// Sizes are random between 1 and 256 bytes in a 1 MiB heap.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "heap.h"
+
+// The heap before size classes: one address-ordered list walked first-fit by
+// MALLOC, searched by FREE and merged end to end after every FREE. Free space
+// is handed back when the last chunk is trimmed, which the old heap missed,
+// and the merge no longer prints.
+class LegacyHeap {
+    struct Chunk {
+        int addr, size;
+        bool free;
+        Chunk *prev, *next;
+    };
+    Chunk *first = nullptr;
+    int size = 0, free = 0, end = 0;
+
+    void unlink(Chunk *c) {
+        (c->prev ? c->prev->next : first) = c->next;
+        if (c->next) c->next->prev = c->prev;
+        delete c;
+    }
+
+public:
+    ~LegacyHeap() {
+        while (first) unlink(first);
+    }
+
+    void heap_init(void *, int, int limit, int) {
+        size = limit;
+        free = limit;
+    }
+
+    int mmalloc(int want) {
+        if (want <= 0) return HEAP_ERR_INVALID_ARG;
+        if (free < want) return HEAP_ERR_OUT_OF_SPACE;
+        Chunk *last = nullptr;
+        for (Chunk *c = first; c; c = c->next) {
+            last = c;
+            if (!c->free || c->size < want) continue;
+            if (c->size != want) {
+                Chunk *n = new Chunk{c->addr, want, false, c->prev, c};
+                (c->prev ? c->prev->next : first) = n;
+                c->prev = n;
+                c->size -= want;
+                c->addr += want;
+                c = n;
+            }
+            c->free = false;
+            free -= want;
+            return c->addr;
+        }
+        if (size - end < want) return HEAP_ERR_OUT_OF_SPACE;
+        Chunk *n = new Chunk{end, want, false, last, nullptr};
+        (last ? last->next : first) = n;
+        end += want;
+        free -= want;
+        return n->addr;
+    }
+
+    int mfree(int ptr) {
+        Chunk *c = first;
+        while (c && c->addr < ptr) c = c->next;
+        if (!c || c->addr != ptr) return HEAP_ERR_NOT_ALLOCATED;
+        if (c->free) return HEAP_ERR_ALREADY_FREE;
+        c->free = true;
+        free += c->size;
+        Chunk *last = nullptr;
+        for (c = first; c; c = c->next) {
+            if (c->free && c->next && c->next->free) {
+                c->size += c->next->size;
+                unlink(c->next);
+            }
+            last = c;
+        }
+        if (last->free) {
+            end -= last->size;
+            unlink(last);
+        }
+        return 0;
+    }
+};
+
+static const int heapSize = 1 << 20;
+static const char *patternNames[] = {"lifo", "fifo", "random"};
+
+// Run `pattern` for `pairs` MALLOC+FREE pairs with `live` allocations held
+// at a time; returns the number of failed MALLOCs
+template <typename H>
+static long churn(H &heap, int pattern, size_t live, long pairs) {
+    std::mt19937 rng(42);
+    std::vector<int> slots;
+    slots.reserve(live);
+    long failed = 0;
+    size_t oldest = 0;
+    auto allocate = [&]() {
+        int addr = heap.mmalloc(1 + rng() % 256);
+        if (addr < 0) failed++;
+        return addr;
+    };
+    auto release = [&](int addr) {
+        if (addr >= 0) heap.mfree(addr);
+    };
+
+    for (size_t i = 0; i < live; i++) slots.push_back(allocate());
+    for (long done = 0; done < pairs;) {
+        if (pattern == 0) {
+            // Free everything newest first, then fill up again
+            for (size_t i = live; i-- > 0 && done < pairs; done++) release(slots[i]);
+            for (size_t i = 0; i < live; i++) slots[i] = allocate();
+        } else if (pattern == 1) {
+            release(slots[oldest]);
+            slots[oldest] = allocate();
+            oldest = (oldest + 1) % live;
+            done++;
+        } else {
+            size_t i = rng() % live;
+            release(slots[i]);
+            slots[i] = allocate();
+            done++;
+        }
+    }
+    for (int addr : slots) release(addr);
+    return failed;
+}
+
+template <typename H>
+static double measure(int pattern, size_t live, long &failed) {
+    double best = 0;
+    long pairs = 20000;
+    for (int round = 0; round < 3; round++) {
+        std::vector<uint8_t> ram(heapSize);
+        H heap;
+        heap.heap_init(ram.data(), 0, heapSize, heapSize);
+        auto start = std::chrono::steady_clock::now();
+        failed = churn(heap, pattern, live, pairs);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = pairs / seconds;
+        if (rate > best) best = rate;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t live = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    if (live == 0) live = 1;
+
+    std::cout << std::left << std::setw(10) << "pattern" << std::right << std::setw(16) << "list pairs/s"
+              << std::setw(16) << "class pairs/s" << std::setw(10) << "speedup" << std::setw(14)
+              << "list fails" << std::setw(14) << "class fails" << "\n";
+    for (int pattern = 0; pattern < 3; pattern++) {
+        long legacyFailed = 0, failed = 0;
+        double legacy = measure<LegacyHeap>(pattern, live, legacyFailed);
+        double current = measure<Heap>(pattern, live, failed);
+        std::cout << std::left << std::setw(10) << patternNames[pattern] << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(16) << legacy << std::setw(16) << current
+                  << std::setw(9) << std::setprecision(1) << current / legacy << "x" << std::setw(14)
+                  << legacyFailed << std::setw(14) << failed << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Vector kernel microbenchmark: runs every vector operation with the scalar,
+// SSE2 and AVX2 kernels the CPU supports and reports elements/sec for each.
+// The scalar kernels are plain C++, which the compiler may vectorize itself
+// for the simpler operations.
+//
+// Usage: masm_bench_vector [element count]
+// The arrays are random and sized to stay in L2 by default.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "microasm_vector.h"
+
+static volatile int64_t sink; // Keeps the reductions from being optimized out
+
+static const char *opNames[] = {"add", "sub", "mul", "min", "max", "sum", "dot"};
+
+static int64_t run(int op, int width, std::vector<uint8_t>& a, const std::vector<uint8_t>& b,
+                   size_t count) {
+    if (op < 5) {
+        vectorBinary((VectorOp)op, width, a.data(), b.data(), count);
+        return 0;
+    }
+    if (op == 5)
+        return vectorSum(width, b.data(), count);
+    return vectorDot(width, a.data(), b.data(), count);
+}
+
+// Best rate over a few rounds of `op` on `count` elements of `width` bytes
+static double measure(int op, int width, std::vector<uint8_t>& a, const std::vector<uint8_t>& b,
+                      size_t count, int64_t& checksum) {
+    checksum = run(op, width, a, b, count);
+    double best = 0;
+    for (int round = 0; round < 5; round++) {
+        int64_t sum = 0;
+        int repeats = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0;
+        while (seconds < 0.05) {
+            sum += run(op, width, a, b, count);
+            repeats++;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        double rate = (double)count * repeats / seconds;
+        if (rate > best) best = rate;
+        sink = sum;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16384;
+
+    std::mt19937 rng(42);
+    std::vector<uint8_t> a(count * 4), b(count * 4);
+    for (auto& byte : b) byte = rng();
+
+    std::vector<VectorIsa> isas = {VectorIsa::SCALAR};
+    if (detectVectorIsa() >= VectorIsa::SSE2) isas.push_back(VectorIsa::SSE2);
+    if (detectVectorIsa() >= VectorIsa::AVX2) isas.push_back(VectorIsa::AVX2);
+
+    std::cout << std::left << std::setw(10) << "op";
+    for (VectorIsa isa : isas)
+        std::cout << std::right << std::setw(16) << (std::string(vectorIsaName(isa)) + " elem/s");
+    std::cout << std::right << std::setw(10) << "speedup" << "\n";
+
+    int mismatches = 0;
+    for (int op = 0; op < 7; op++) {
+        for (int width : {1, 2, 4}) {
+            std::cout << std::left << std::setw(10)
+                      << (std::string(opNames[op]) + (width == 1 ? "b" : width == 2 ? "w" : "d"));
+            double scalar = 0, last = 0;
+            int64_t expected = 0;
+            for (VectorIsa isa : isas) {
+                setVectorIsa(isa);
+                // Binary ops update `a` in place, start each ISA from the same data
+                for (size_t i = 0; i < a.size(); i++) a[i] = b[(i * 7) % b.size()];
+                int64_t checksum = 0;
+                last = measure(op, width, a, b, count, checksum);
+                if (isa == VectorIsa::SCALAR) {
+                    scalar = last;
+                    expected = checksum;
+                } else if (op >= 5 && checksum != expected) {
+                    mismatches++;
+                }
+                std::cout << std::right << std::setw(16) << std::fixed << std::setprecision(0) << last;
+            }
+            std::cout << std::right << std::setw(9) << std::setprecision(1)
+                      << (scalar > 0 ? last / scalar : 0) << "x\n";
+        }
+    }
+    setVectorIsa(detectVectorIsa());
+    if (mismatches) {
+        std::cerr << mismatches << " reductions disagree with the scalar kernels\n";
+        return 1;
+    }
+    return 0;
+}
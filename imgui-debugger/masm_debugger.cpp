@@ -28,6 +28,7 @@ struct DebuggerState {
     int lastIP = 0;
     std::vector<std::string> programArgs;
     std::set<int> breakpoints;
+    int ramSize = MEMORY_SIZE;
 };
 
 void DrawDebuggerUI(DebuggerState& state) {
@@ -38,7 +39,7 @@ void DrawDebuggerUI(DebuggerState& state) {
     static std::string lastLoadError; // Add this line
     ImGui::InputText("Bytecode File", fileBuf, sizeof(fileBuf));
     if (ImGui::Button("Load")) {
-        state.interpreter = std::make_unique<Interpreter>(65536, state.programArgs, true);
+        state.interpreter = std::make_unique<Interpreter>(state.ramSize, state.programArgs, true);
         try {
             state.interpreter->load(fileBuf);
             state.loadedFile = fileBuf;
@@ -68,7 +69,7 @@ void DrawDebuggerUI(DebuggerState& state) {
         }
         ImGui::SameLine();
         if (ImGui::Button("Reset")) {
-            state.interpreter = std::make_unique<Interpreter>(65536, state.programArgs, true);
+            state.interpreter = std::make_unique<Interpreter>(state.ramSize, state.programArgs, true);
             state.interpreter->load(state.loadedFile);
             state.running = false;
         }
@@ -90,7 +91,19 @@ void DrawDebuggerUI(DebuggerState& state) {
     ImGui::End();
 }
 
-int main(int, char**) {
+int main(int argc, char** argv) {
+    DebuggerState dbgState;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--ram") {
+            try {
+                dbgState.ramSize = parseRamSize(argv[++i]);
+            } catch (const std::exception& e) {
+                printf("Error: %s\n", e.what());
+                return -1;
+            }
+        }
+    }
+
     // SDL2 + ImGui setup
     if (SDL_Init(SDL_INIT_VIDEO|SDL_INIT_TIMER) != 0) {
         printf("Error: %s\n", SDL_GetError());
@@ -106,8 +119,6 @@ int main(int, char**) {
     ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
     ImGui_ImplSDLRenderer2_Init(renderer);
 
-    DebuggerState dbgState;
-
     bool done = false;
     while (!done) {
         SDL_Event event;
@@ -22,13 +22,17 @@
 struct BinaryHeader {
     uint32_t magic = 0x4D53414D; // "MASM" in ASCII (little-endian)
     uint16_t version = 1;
-    uint16_t reserved = 0; // Padding/Reserved for future use
+    uint16_t flags = 0; // BINARY_FLAG_* bits, version 3 and later (0 before)
     uint32_t codeSize = 0;
     uint32_t dataSize = 0;
     uint32_t dbgSize = 0;
     uint32_t entryPoint = 0; // Offset within the code segment
 };
 
+// BinaryHeader::flags
+constexpr uint16_t BINARY_FLAG_WIDE_REGISTERS = 0x1; // 64-bit registers and arithmetic
+constexpr uint16_t BINARY_FLAG_WIDE_DATA = 0x2;      // Data records with 32-bit address and size
+
 // Opcode Enum
 enum Opcode {
     // Basic
@@ -62,6 +66,21 @@ enum Opcode {
     MALLOC,
     FREE,
     MOVB,
+    // Moves of an explicit width: 2, 4 and 8 bytes (MOVB is 1)
+    MOVW, MOVD, MOVQ,
+    // LOOP reg #label: decrement and branch while non-zero. CJcc a b #label:
+    // compare and branch without touching the flags.
+    LOOP, CJE, CJNE, CJL, CJG, CJLE, CJGE,
+    // JMPTAB index $table: jump through a table emitted by the DT directive
+    JMPTAB,
+    // Vector instructions over RAM ranges of 8/16/32-bit elements (B/W/D):
+    // VADDB dest src n adds n elements of src to dest, VSUMB n src and
+    // VDOTB n a b replace the element count n with the sum or dot product.
+    VADDB, VADDW, VADDD, VSUBB, VSUBW, VSUBD, VMULB, VMULW, VMULD,
+    VMINB, VMINW, VMIND, VMAXB, VMAXW, VMAXD, VSUMB, VSUMW, VSUMD,
+    VDOTB, VDOTW, VDOTD,
+    // SBRK dest n: move the end of the heap by n bytes, dest gets the old end
+    SBRK,
     // Pseudo-instructions (handled during compilation, not runtime)
     INCLUDE = 0xF2, // Placeholder for include directive logic (handled pre-compilation)
 };
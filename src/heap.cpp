@@ -4,162 +4,257 @@
 // int free(int) - free data
 
 #include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
 #include <string>
 #include "heap.h"
 #include "common_defs.h"
+#include "microasm_ram.h"
 
-struct heap_data metadata;
+#define HEAP_FIELD(field) (base + (uint32_t)offsetof(heap_data, field))
+#define HEAP_BIN(i) (HEAP_FIELD(bins) + 4 * (uint32_t)(i))
 
-void delete_chunk(heap_chunk* chunk) {
-    if (metadata.first == chunk) {
-        if (chunk->next != NULL) {
-            metadata.first = chunk->next;
-        } else {
-            metadata.first = NULL;
-        }
-    } else {
-        chunk->prev->next = chunk->next;
-        if (chunk->next != NULL) {
-            chunk->next->prev = chunk->prev;
-        }
-    }
-    free(chunk);
+Heap::Heap() {
+    heap_init(NULL, 0, 0, 0);
 }
 
-struct heap_chunk* get_last() {
-    struct heap_chunk *last = metadata.first;
-    while (last->next != NULL) {
-        last = last->next;
-    }
-    return last;
+uint32_t Heap::load(uint32_t addr) const {
+    uint32_t value = 0;
+    if (addr >= base && limit - base >= 4 && addr <= limit - 4)
+        memcpy(&value, memory + addr, 4);
+    return value;
+}
+
+void Heap::store(uint32_t addr, uint32_t value) {
+    if (addr >= base && limit - base >= 4 && addr <= limit - 4)
+        memcpy(memory + addr, &value, 4);
+}
+
+bool Heap::ready() const {
+    return limit - base >= HEAP_CONTROL && load(HEAP_FIELD(magic)) == HEAP_MAGIC;
+}
+
+// Size class of a chunk, floor(log2(size))
+int Heap::bin_index(uint32_t size) {
+    return size != 0 ? 31 - __builtin_clz(size) : 0;
 }
 
-void heap_init() {
-    metadata.size = MEMORY_SIZE-STACK_SIZE;
-    metadata.used = 0;
-    metadata.free = metadata.size;
+void Heap::bin_insert(uint32_t chunk, uint32_t size) {
+    int bin = bin_index(size);
+    uint32_t next = load(HEAP_BIN(bin));
+    store(chunk, size | HEAP_FREE);
+    store(chunk + 4, chunk ^ HEAP_TAG);
+    store(chunk + 8, next);
+    store(chunk + 12, 0);
+    store(chunk + size - 4, size);
+    if (next != 0)
+        store(next + 12, chunk);
+    store(HEAP_BIN(bin), chunk);
+    store(HEAP_FIELD(bin_mask), load(HEAP_FIELD(bin_mask)) | (1u << bin));
+}
+
+void Heap::bin_remove(uint32_t chunk, uint32_t size) {
+    int bin = bin_index(size);
+    uint32_t next = load(chunk + 8);
+    uint32_t prev = load(chunk + 12);
+    if (prev != 0)
+        store(prev + 8, next);
+    else
+        store(HEAP_BIN(bin), next);
+    if (next != 0)
+        store(next + 12, prev);
+    if (load(HEAP_BIN(bin)) == 0)
+        store(HEAP_FIELD(bin_mask), load(HEAP_FIELD(bin_mask)) & ~(1u << bin));
+}
 
-    metadata.start = 0;
-    metadata.end = 0;
+void Heap::heap_init(void *memory, int base, int limit, int max, bool mapped) {
+    this->memory = (uint8_t *)memory;
+    this->mapped = mapped;
+    if (memory == NULL || base < 0)
+        base = limit = max = 0;
+    if (limit < base)
+        limit = base;
+    if (max < limit)
+        max = limit;
+    this->base = base;
+    this->limit = limit;
+    this->max = max;
+}
+
+void Heap::heap_copy(const Heap &other, void *memory) {
+    heap_init(memory, other.base, other.limit, other.max, other.mapped);
+}
 
-    metadata.chunks = 0;
-    metadata.first = NULL;
+// Drop the pages of [from, to), which holds nothing the heap needs
+void Heap::release(uint32_t from, uint32_t to) {
+    if (mapped && to > from && to - from >= HEAP_RELEASE && from >= base && to <= limit)
+        releaseRamPages(memory + from, to - from);
 }
 
-int mmalloc(int size) {
+// Allocate the first `size` bytes of the free chunk and put the rest back on
+// a free list
+int Heap::take(uint32_t chunk, uint32_t size) {
+    uint32_t chunk_size = load(chunk) & ~(HEAP_ALIGN - 1);
+    bin_remove(chunk, chunk_size);
+    if (chunk_size - size >= HEAP_MIN_CHUNK) {
+        // split available chunk so if malloc(10) is called and we have a 40 byte chunk it becomes a 16 and a 24 byte chunk
+        bin_insert(chunk + size, chunk_size - size);
+    } else {
+        size = chunk_size;
+        uint32_t next = chunk + size;
+        if (next < load(HEAP_FIELD(end)))
+            store(next, load(next) & ~HEAP_PREV_FREE);
+    }
+    store(chunk, size);
+    store(chunk + 4, chunk ^ HEAP_TAG);
+    store(HEAP_FIELD(used), load(HEAP_FIELD(used)) + size);
+    return chunk + HEAP_HEADER;
+}
+
+int Heap::mmalloc(int size) {
         // make new chuck of size (size)
-    if (size <= 0) 
+    if (size <= 0)
         return HEAP_ERR_INVALID_ARG;
-    else if (metadata.free < size) 
+    else if ((uint32_t)size > max - base)
         return HEAP_ERR_OUT_OF_SPACE;
-    
-    struct heap_chunk *new_chunk = internal_make_chunk(metadata.end, size);
-
-    struct heap_chunk *c = metadata.first;
-    while (c != NULL) {
-        if (c->size >= size && c->free) {
-            // found free chunk
-            // split available chunk so if malloc(10) is called and we have a 20 byte chunk it becomes a two 10 byte chunks
-            new_chunk->addr = c->addr;
-
-            // append chunk to metadata.chunks
-            if (c->size != size) {
-                new_chunk->prev = c->prev;
-                new_chunk->next = c;
-                c->prev->next = new_chunk;
-                c->prev = new_chunk;
-
-                c->size -= size;
-                c->addr += size;
-                return new_chunk->addr;
-            } else {
-                c->free = false;
-                return c->addr;
-            }
-        }
-        c = c->next;
+
+    if (!ready()) {
+        if (max - base < HEAP_CONTROL + HEAP_MIN_CHUNK)
+            return HEAP_ERR_OUT_OF_SPACE;
+        if (limit - base < HEAP_CONTROL)
+            limit = base + HEAP_CONTROL;
+        memset(memory + base, 0, HEAP_CONTROL);
+        store(HEAP_FIELD(magic), HEAP_MAGIC);
+        store(HEAP_FIELD(end), base + HEAP_CONTROL);
     }
-    // actually do work.
-    new_chunk->addr = metadata.end;
-    new_chunk->next = NULL;
-
-    metadata.used += size;
-    metadata.free -= size;
-    metadata.end += size;
-
-    // append chunk to metadata.chunks
-    
-    if (metadata.first == NULL) {
-        new_chunk->prev = NULL;
-        metadata.first = new_chunk;
-    } else {
-        new_chunk->prev = get_last();
-        new_chunk->prev->next = new_chunk;
+
+    uint32_t need = ((uint32_t)size + HEAP_HEADER + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1);
+    if (need < HEAP_MIN_CHUNK)
+        need = HEAP_MIN_CHUNK;
+
+    // a few chunks of the same size class, which may be too small
+    int bin = bin_index(need);
+    uint32_t c = load(HEAP_BIN(bin));
+    for (int scanned = 0; c != 0 && scanned < HEAP_BIN_SCAN; scanned++) {
+        if ((load(c) & ~(HEAP_ALIGN - 1)) >= need)
+            return take(c, need);
+        c = load(c + 8);
     }
 
-    return new_chunk->addr;
-}
+    // any chunk of a larger size class fits
+    uint32_t larger = load(HEAP_FIELD(bin_mask)) & ~((2u << bin) - 1);
+    if (larger)
+        return take(load(HEAP_BIN(__builtin_ctz(larger))), need);
 
-struct heap_chunk* internal_make_chunk(int addr, int size) {
-    struct heap_chunk* c = (struct heap_chunk*)malloc(sizeof(heap_chunk));
-    c->size = size;
-    c->addr = addr;
-    c->free = false;
-    return c;
+    // actually do work, raising the break if the space above the last chunk
+    // is too small
+    uint32_t end = load(HEAP_FIELD(end));
+    if (end >= base && end <= limit && max - end >= need) {
+        if (limit - end < need)
+            limit = end + need;
+        store(end, need);
+        store(end + 4, end ^ HEAP_TAG);
+        store(HEAP_FIELD(end), end + need);
+        store(HEAP_FIELD(used), load(HEAP_FIELD(used)) + need);
+        return end + HEAP_HEADER;
+    }
+
+    // the rest of the size class before giving up, bounded in case the list
+    // was overwritten into a cycle
+    for (uint32_t left = (limit - base) / HEAP_MIN_CHUNK; c != 0 && left > 0; left--) {
+        if ((load(c) & ~(HEAP_ALIGN - 1)) >= need)
+            return take(c, need);
+        c = load(c + 8);
+    }
+    return HEAP_ERR_OUT_OF_SPACE;
 }
 
-int mfree(int ptr) {
+int Heap::mfree(int ptr) {
     // free chunk ptr
-    struct heap_chunk *c = metadata.first;
-    while (c != NULL && c->addr <= ptr) {
-        if (c->addr == ptr) {
-            if (c->free) {return HEAP_ERR_ALREADY_FREE;}
-            c->free = true;
-            defragment();
-            return 0;
-        }
-        c = c->next;
+    if (!ready())
+        return HEAP_ERR_NOT_ALLOCATED;
+    uint32_t c = (uint32_t)ptr - HEAP_HEADER;
+    uint32_t end = load(HEAP_FIELD(end));
+    if (ptr < (int)(base + HEAP_CONTROL + HEAP_HEADER) || c >= end || (c - base) % HEAP_ALIGN != 0 ||
+        load(c + 4) != (c ^ HEAP_TAG))
+        return HEAP_ERR_NOT_ALLOCATED;
+    uint32_t header = load(c);
+    if (header & HEAP_FREE)
+        return HEAP_ERR_ALREADY_FREE;
+    uint32_t size = header & ~(HEAP_ALIGN - 1);
+    if (size < HEAP_MIN_CHUNK || size > end - c)
+        return HEAP_ERR_NOT_ALLOCATED;
+    store(HEAP_FIELD(used), load(HEAP_FIELD(used)) - size);
+
+    // merge with the chunk above, free chunks never touch the end
+    uint32_t next = c + size;
+    if (next < end && (load(next) & HEAP_FREE)) {
+        uint32_t next_size = load(next) & ~(HEAP_ALIGN - 1);
+        bin_remove(next, next_size);
+        store(next + 4, 0);
+        size += next_size;
     }
-    return HEAP_ERR_NOT_ALLOCATED;
-}
 
-void defragment() {
-    struct heap_chunk *c = metadata.first;
-    while (c != NULL) {
-        if (c->free && c->next != NULL && c->next->free) {
-            std::cout << "Defragmenting data: Chunk 1 addr: " << std::to_string(c->addr) << " size: " << std::to_string(c->size) << "\nChunk 2 addr" << std::to_string(c->next->addr) << " size: " << std::to_string(c->next->size) << std::endl;
-            c->size += c->next->size;
-            delete_chunk(c->next);
-        }
-        c = c->next;
+    // merge with the chunk below, its size is in the footer
+    uint32_t prev_size = load(c - 4);
+    if ((header & HEAP_PREV_FREE) && prev_size >= HEAP_MIN_CHUNK && prev_size <= c - base - HEAP_CONTROL) {
+        bin_remove(c - prev_size, prev_size);
+        store(c + 4, 0);
+        c -= prev_size;
+        size += prev_size;
     }
-    struct heap_chunk *last = get_last();
-    if (last->free) {
-        metadata.end -= last->size;
-        delete_chunk(last);
+
+    next = c + size;
+    if (next < end) {
+        bin_insert(c, size);
+        store(next, load(next) | HEAP_PREV_FREE);
+        // keep the header, links and footer
+        release(c + 16, next - 4);
+    } else {
+        // the last chunk goes back to the untouched space
+        store(c + 4, 0);
+        store(HEAP_FIELD(end), c);
+        release(c, end);
     }
+    return 0;
 }
 
-void check_unfreed_memory() {
-    struct heap_chunk *c = metadata.first;
-    while (c != NULL) {
-        if (!c->free) {
-            std::cout << "Warning: Unfreed memory at address 0x" << std::hex << c->addr << std::dec << " with size 0x" << std::hex << c->size << std::dec << std::endl;
+int Heap::msbrk(int increment) {
+    // the control block and every chunk must stay below the break
+    uint32_t low = ready() ? load(HEAP_FIELD(end)) : base;
+    int64_t brk = (int64_t)limit + increment;
+    if (brk < low || brk > max)
+        return HEAP_ERR_OUT_OF_SPACE;
+    int old = limit;
+    limit = brk;
+    return old;
+}
+
+int Heap::used() const {
+    return ready() ? load(HEAP_FIELD(used)) : 0;
+}
+
+void Heap::check_unfreed_memory() {
+    if (ready()) {
+        uint32_t end = load(HEAP_FIELD(end));
+        uint32_t size;
+        for (uint32_t c = base + HEAP_CONTROL; c < end; c += size) {
+            uint32_t header = load(c);
+            size = header & ~(HEAP_ALIGN - 1);
+            if (size < HEAP_MIN_CHUNK)
+                break;
+            if (!(header & HEAP_FREE)) {
+                std::cout << "Warning: Unfreed memory at address 0x" << std::hex << c + HEAP_HEADER << std::dec << " with size 0x" << std::hex << size - HEAP_HEADER << std::dec << std::endl;
+            }
         }
-        struct heap_chunk *c_next = c->next;
-        free(c);
-        c = c_next;
     }
+    check_unfreed_memory(true);
 }
 
-void check_unfreed_memory(bool silence) {
+void Heap::check_unfreed_memory(bool silence) {
     if (!silence) {
         return check_unfreed_memory();
     }
-    struct heap_chunk *c = metadata.first;
-    while (c != NULL) {
-        struct heap_chunk *c_next = c->next;
-        free(c);
-        c = c_next;
-    }
+    if (ready())
+        store(HEAP_FIELD(magic), 0);
 }
\ No newline at end of file
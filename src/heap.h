@@ -5,10 +5,24 @@
 // int malloc(size) - get (size) bytes
 
 // int free(int) - free data
+
+// Every Interpreter owns its own Heap, so interpreters in one process (or on
+// different threads) never share heap state.
+
+// All heap state lives in the masm RAM it manages, so a copy of RAM is a copy
+// of the heap. The heap is [base, limit) of RAM. limit (the break) starts at
+// base and MALLOC or SBRK raise it as needed, up to max. A control block (heap_data) sits at base and chunks tile
+// [base + HEAP_CONTROL, end) above it; everything above end is untouched.
+// Each chunk starts with an 8 byte header: its size with the HEAP_FREE and
+// HEAP_PREV_FREE flags, then its address ^ HEAP_TAG, which FREE checks. Free
+// chunks also hold the links of their size class free list (sizes
+// [2^i, 2^(i+1)) go to bin i) and end with a copy of their size, so FREE
+// finds both neighbours in constant time.
 #ifndef _MASM_HEAP
 #define _MASM_HEAP
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <iostream>
 
 #define HEAP_ERR_ALREADY_FREE -1
@@ -16,40 +30,83 @@
 #define HEAP_ERR_OUT_OF_SPACE -3
 #define HEAP_ERR_INVALID_ARG -4
 
+#define HEAP_BINS 32
+// Blocks of the requested size class checked before a larger class is used
+#define HEAP_BIN_SCAN 8
+
+#define HEAP_MAGIC 0x7061656D // "meap", set once the control block is written
+#define HEAP_TAG 0x6D61736D
+#define HEAP_ALIGN 8
+#define HEAP_HEADER 8
+#define HEAP_MIN_CHUNK 24 // Header, free list links and footer
+#define HEAP_FREE 1
+#define HEAP_PREV_FREE 2
+// Free space of at least this many bytes has its pages given back to the
+// kernel when the RAM is mapped
+#define HEAP_RELEASE 65536
+
+// The control block at the start of the heap, 0 is "none" for addresses
+// since no chunk can start at RAM address 0
 struct heap_data {
-    int size;
-    int used;
-    int free;
-
-    int start;
-    int end;
-
-    int chunks;
+    uint32_t magic;
+    uint32_t end; // End of the last chunk
+    uint32_t used; // Bytes in allocated chunks, headers included
 
-    struct heap_chunk *first;
-
-    int stack;
+    uint32_t bin_mask; // Bit i set while bins[i] is not empty
+    uint32_t bins[HEAP_BINS]; // First free chunk of each size class
 };
 
-struct heap_chunk {
-    int size;
-    int addr;
-    bool free;
-    struct heap_chunk *next;
-    struct heap_chunk *prev;
+#define HEAP_CONTROL ((uint32_t)sizeof(heap_data))
+
+class Heap {
+    uint8_t *memory; // The masm RAM the heap is in
+    uint32_t base;   // Heap addresses are [base, limit)
+    uint32_t limit;
+    uint32_t max;    // Highest limit msbrk can set
+    bool mapped;     // memory is a mapped Ram whose pages can be released
+
+    // Corrupted metadata can point anywhere, so loads outside the heap read
+    // 0 and stores outside it are dropped
+    uint32_t load(uint32_t addr) const;
+    void store(uint32_t addr, uint32_t value);
+
+    bool ready() const;
+    void release(uint32_t from, uint32_t to);
+    static int bin_index(uint32_t size);
+    void bin_insert(uint32_t chunk, uint32_t size);
+    void bin_remove(uint32_t chunk, uint32_t size);
+    int take(uint32_t chunk, uint32_t size);
+
+public:
+    Heap();
+    Heap(const Heap &) = delete;
+    Heap &operator=(const Heap &) = delete;
+
+    // Manage addresses [base, limit) of memory, with room to grow to max.
+    // mmalloc raises limit itself when it needs more space.
+    // Nothing is written until the first mmalloc, so RAM a program never
+    // allocates from is left alone. With mapped set, large free regions are
+    // handed back to the kernel and read as zero afterwards.
+    void heap_init(void *memory, int base, int limit, int max, bool mapped = false);
+
+    // Manage the same addresses as other in memory, a copy of other's RAM
+    void heap_copy(const Heap &other, void *memory);
+
+    int mmalloc(int size);
+
+    int mfree(int ptr);
+
+    // Move the break by increment bytes and return the old one. It cannot
+    // pass max or drop below the end of the last chunk. Space between the
+    // last chunk and the break is the heap's, mmalloc hands it out next.
+    int msbrk(int increment);
+
+    // Report chunks that were never freed, then empty the heap
+    void check_unfreed_memory();
+    void check_unfreed_memory(bool silence);
+
+    int size() const { return limit - base; }
+    int used() const;
 };
 
-void heap_init();
-
-int mmalloc(int size);
-
-int mfree(int ptr);
-
-void defragment();
-
-void check_unfreed_memory();
-void check_unfreed_memory(bool silence);
-
-struct heap_chunk* internal_make_chunk(int addr, int size);
-
 #endif
\ No newline at end of file
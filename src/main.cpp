@@ -77,6 +77,9 @@ int main(int argc, char* argv[]) {
             "  -u  Decode/disassemble a binary file.", // <-- Add this line
             "Options:",
             "  -d, --debug  Enable debug mode.",
+            "  -w, --wide   Compile with 64-bit registers (with -c).",
+            "  --ram <size> RAM in bytes, or with a K, M or G suffix.",
+            "  --vector-isa=scalar|sse2|avx2  Vector kernels to use (with -i).",
             "Examples:",
             "  microasm -c example.masm",
             "  microasm -i example.masm",
@@ -122,7 +125,7 @@ int main(int argc, char* argv[]) {
         int addr2 = machine.getValue(args[1], 4);
         std::string s1 = machine.readRamString(addr1);
         std::string s2 = machine.readRamString(addr2);
-        machine.zeroFlag = (s1 == s2);
+        machine.setZeroFlag(s1 == s2);
     });
     // -- end registering functions --
 
@@ -217,13 +220,18 @@ int main(int argc, char* argv[]) {
             // --- Interpret Step ---
             // Prepare arguments for the interpreted program (skip program name and source file)
             std::vector<std::string> programArgs;
+            int ramSize = MEMORY_SIZE;
             // Arguments start from argv[2] onwards
             for (int i = 2; i < argc; ++i) {
+                if (std::string(argv[i]) == "--ram" && i + 1 < argc) {
+                    ramSize = parseRamSize(argv[++i]);
+                    continue;
+                }
                 programArgs.push_back(argv[i]);
             }
 
             if (enableDebug) std::cout << "[Debug] Interpreting " << tempBinary << "\n";
-            Interpreter interpreter(65536, programArgs, enableDebug); // Pass debug flag to interpreter class
+            Interpreter interpreter(ramSize, programArgs, enableDebug); // Pass debug flag to interpreter class
             interpreter.load(tempBinary);
             interpreter.execute();
 
@@ -258,6 +266,8 @@ int main(int argc, char* argv[]) {
              "  <file.masm>    Compile and run a .masm file directly.",
              "Options:",
              "  -d, --debug    Enable debug mode.",
+             "  -w, --wide     Compile with 64-bit registers (with -c).",
+             "  --ram <size>   RAM in bytes, or with a K, M or G suffix.",
              "Examples:",
              "  microasm -c example.masm",
              "  microasm -i example.masm",
@@ -1,10 +1,21 @@
 #include "microasm_capi.h"
 #include "microasm_interpreter.h" // Include the C++ interpreter class
+#include <cstddef>
+#include <cstring>
+#include <memory>
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <iostream> // For potential error logging
 
+// masm_get_registers/masm_set_registers copy the register file as a whole
+static_assert(sizeof(MasmRegisters) == sizeof(Interpreter::registers),
+              "MasmRegisters must match the interpreter's register file");
+static_assert(offsetof(MasmRegisters, rbp) == 6 * sizeof(int64_t) &&
+              offsetof(MasmRegisters, rsp) == 7 * sizeof(int64_t) &&
+              offsetof(MasmRegisters, r) == 8 * sizeof(int64_t),
+              "MasmRegisters must follow the register indices");
+
 // --- Error Handling ---
 // Simple thread-unsafe error storage. Use thread_local for safety in multithreaded scenarios.
 // thread_local std::string lastErrorMessage;
@@ -24,11 +35,16 @@ const char* masm_get_last_error() {
 
 // Define the opaque struct locally
 struct InterpreterOpaque {
-    Interpreter interpreter; // Contains the actual C++ interpreter instance
+    std::unique_ptr<Interpreter> owned;
+    Interpreter &interpreter; // The actual C++ interpreter instance
 
     // Constructor to initialize the interpreter
     InterpreterOpaque(int ramSize, bool debug)
-        : interpreter(ramSize, {}, debug) {} // Initialize with empty args initially
+        : owned(new Interpreter(ramSize, {}, debug)), interpreter(*owned) {} // Initialize with empty args initially
+
+    // Take over an interpreter made by Interpreter::clone()
+    explicit InterpreterOpaque(std::unique_ptr<Interpreter> clone)
+        : owned(std::move(clone)), interpreter(*owned) {}
 };
 
 // --- C API Implementation ---
@@ -63,6 +79,26 @@ void masm_destroy_interpreter(InterpreterOpaque* handle) {
     }
 }
 
+InterpreterOpaque* masm_clone_interpreter(InterpreterOpaque* handle) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return nullptr;
+    }
+    try {
+        return new InterpreterOpaque(handle->interpreter.clone());
+    } catch (const std::bad_alloc&) {
+        setLastError("Failed to allocate memory for interpreter clone.");
+        return nullptr;
+    } catch (const std::exception& e) {
+        setLastError("Failed to clone interpreter: " + std::string(e.what()));
+        return nullptr;
+    } catch (...) {
+        setLastError("An unknown error occurred during interpreter cloning.");
+        return nullptr;
+    }
+}
+
 MasmResult masm_load_bytecode(InterpreterOpaque* handle, const char* bytecodeFile) {
     setLastError("");
     if (handle == nullptr) {
@@ -127,6 +163,30 @@ MasmResult masm_execute(InterpreterOpaque* handle, int argc, const char* const*
     }
 }
 
+MasmResult masm_run_for(InterpreterOpaque* handle, uint64_t budget, MasmRunStatus* outStatus) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    if (outStatus == nullptr) {
+        setLastError("Output status pointer cannot be null.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        ExecutionStatus status = handle->interpreter.execute(budget);
+        *outStatus = status == ExecutionStatus::SUSPENDED ? MASM_STATUS_SUSPENDED
+                                                          : MASM_STATUS_HALTED;
+        return MASM_OK;
+    } catch (const std::exception& e) {
+        setLastError("Runtime execution error: " + std::string(e.what()));
+        return MASM_ERROR_EXECUTION_FAILED;
+    } catch (...) {
+        setLastError("An unknown error occurred during execution.");
+        return MASM_ERROR_EXECUTION_FAILED;
+    }
+}
+
 MasmResult masm_get_register(InterpreterOpaque* handle, int registerIndex, int32_t* outValue) {
     setLastError("");
     if (handle == nullptr) {
@@ -137,12 +197,12 @@ MasmResult masm_get_register(InterpreterOpaque* handle, int registerIndex, int32
         setLastError("Output value pointer cannot be null.");
         return MASM_ERROR_INVALID_ARGUMENT;
     }
-    if (registerIndex < 0 || registerIndex >= handle->interpreter.registers.size()) {
+    if (registerIndex < 0 || registerIndex >= REGISTER_COUNT) {
         setLastError("Register index out of bounds.");
         return MASM_ERROR_INVALID_ARGUMENT;
     }
     try {
-        *outValue = handle->interpreter.registers[registerIndex];
+        *outValue = (int32_t)handle->interpreter.registers[registerIndex];
         return MASM_OK;
     } catch (const std::exception& e) {
         setLastError("Error getting register value: " + std::string(e.what()));
@@ -153,6 +213,83 @@ MasmResult masm_get_register(InterpreterOpaque* handle, int registerIndex, int32
     }
 }
 
+MasmResult masm_get_register64(InterpreterOpaque* handle, int registerIndex, int64_t* outValue) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    if (outValue == nullptr) {
+        setLastError("Output value pointer cannot be null.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    if (registerIndex < 0 || registerIndex >= REGISTER_COUNT) {
+        setLastError("Register index out of bounds.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    *outValue = handle->interpreter.registers[registerIndex];
+    return MASM_OK;
+}
+
+MasmResult masm_get_register_width(InterpreterOpaque* handle, int* outBits) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    if (outBits == nullptr) {
+        setLastError("Output width pointer cannot be null.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    *outBits = handle->interpreter.hasWideRegisters() ? 64 : 32;
+    return MASM_OK;
+}
+
+MasmResult masm_get_registers(InterpreterOpaque* handle, MasmRegisters* outRegisters) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    if (outRegisters == nullptr) {
+        setLastError("Output registers pointer cannot be null.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    std::memcpy(outRegisters, handle->interpreter.registers.data(), sizeof(MasmRegisters));
+    return MASM_OK;
+}
+
+MasmResult masm_set_registers(InterpreterOpaque* handle, const MasmRegisters* registers) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    if (registers == nullptr) {
+        setLastError("Registers pointer cannot be null.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    std::memcpy(handle->interpreter.registers.data(), registers, sizeof(MasmRegisters));
+    for (int64_t &reg : handle->interpreter.registers)
+        reg = handle->interpreter.toRegister(reg);
+    return MASM_OK;
+}
+
+MasmResult masm_get_flags(InterpreterOpaque* handle, int* outZeroFlag, int* outSignFlag) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    if (outZeroFlag == nullptr || outSignFlag == nullptr) {
+        setLastError("Output flag pointers cannot be null.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    *outZeroFlag = handle->interpreter.getZeroFlag();
+    *outSignFlag = handle->interpreter.getSignFlag();
+    return MASM_OK;
+}
+
 MasmResult masm_read_ram_int(InterpreterOpaque* handle, int address, int32_t* outValue) {
     setLastError("");
      if (handle == nullptr) {
@@ -193,5 +330,38 @@ MasmResult masm_write_ram_int(InterpreterOpaque* handle, int address, int32_t va
     }
 }
 
+MasmResult masm_read_ram_int64(InterpreterOpaque* handle, int address, int64_t* outValue) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    if (outValue == nullptr) {
+        setLastError("Output value pointer cannot be null.");
+        return MASM_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        *outValue = handle->interpreter.readRamNum(address, 8);
+        return MASM_OK;
+    } catch (const std::exception& e) {
+        setLastError("Error reading RAM: " + std::string(e.what()));
+        return MASM_ERROR_MEMORY;
+    }
+}
+
+MasmResult masm_write_ram_int64(InterpreterOpaque* handle, int address, int64_t value) {
+    setLastError("");
+    if (handle == nullptr) {
+        setLastError("Invalid interpreter handle.");
+        return MASM_ERROR_INVALID_HANDLE;
+    }
+    try {
+        handle->interpreter.writeRamNum(address, value, 8);
+        return MASM_OK;
+    } catch (const std::exception& e) {
+        setLastError("Error writing RAM: " + std::string(e.what()));
+        return MASM_ERROR_MEMORY;
+    }
+}
 
 } // extern "C"
@@ -22,6 +22,21 @@ typedef enum {
     MASM_ERROR_MEMORY = -6
 } MasmResult;
 
+// Why masm_run_for returned
+typedef enum {
+    MASM_STATUS_HALTED = 0,   // HLT or the end of the program was reached
+    MASM_STATUS_SUSPENDED = 1 // The budget ran out, call masm_run_for again to continue
+} MasmRunStatus;
+
+// The register file, in the same order as register indices 0-23. Programs
+// without 64-bit registers keep sign-extended 32-bit values here.
+typedef struct {
+    int64_t rax, rbx, rcx, rdx, rsi, rdi;
+    int64_t rbp; // Base pointer
+    int64_t rsp; // Stack pointer
+    int64_t r[16]; // R0-R15
+} MasmRegisters;
+
 /**
  * @brief Creates a new MicroASM interpreter instance.
  * @param ramSize The size of the RAM for the interpreter in bytes.
@@ -36,6 +51,16 @@ MASM_API MasmInterpreterHandle masm_create_interpreter(int ramSize, int debugMod
  */
 MASM_API void masm_destroy_interpreter(MasmInterpreterHandle handle);
 
+/**
+ * @brief Creates a copy of an interpreter in its current state, usually right after masm_load_bytecode.
+ * The copy shares the loaded code and starts with a copy-on-write view of the original's RAM,
+ * so no file is read and only pages that either side writes are copied.
+ * The original must not be running during the call.
+ * @param handle The handle to the interpreter to copy.
+ * @return A handle to the new interpreter, or NULL on failure. Free it with masm_destroy_interpreter.
+ */
+MASM_API MasmInterpreterHandle masm_clone_interpreter(MasmInterpreterHandle handle);
+
 /**
  * @brief Loads MicroASM bytecode from a file into the interpreter.
  * @param handle The handle to the interpreter instance.
@@ -53,8 +78,20 @@ MASM_API MasmResult masm_load_bytecode(MasmInterpreterHandle handle, const char*
  */
 MASM_API MasmResult masm_execute(MasmInterpreterHandle handle, int argc, const char* const* argv);
 
+/**
+ * @brief Executes the loaded bytecode for about `budget` instructions.
+ * The budget is checked at the end of each basic block, so a call can retire a
+ * few instructions more. A suspended program continues with the next call.
+ * @param handle The handle to the interpreter instance.
+ * @param budget Number of instructions to run before suspending.
+ * @param outStatus Pointer to store whether the program halted or was suspended.
+ * @return MASM_OK on success, or an error code on failure (runtime error).
+ */
+MASM_API MasmResult masm_run_for(MasmInterpreterHandle handle, uint64_t budget, MasmRunStatus* outStatus);
+
 /**
  * @brief Gets the value of a specific register.
+ * A 64-bit register is truncated to its low 32 bits, use masm_get_register64 for those.
  * @param handle The handle to the interpreter instance.
  * @param registerIndex The index of the register (0-23).
  * @param outValue Pointer to store the register value.
@@ -62,6 +99,49 @@ MASM_API MasmResult masm_execute(MasmInterpreterHandle handle, int argc, const c
  */
 MASM_API MasmResult masm_get_register(MasmInterpreterHandle handle, int registerIndex, int32_t* outValue);
 
+/**
+ * @brief Gets the full 64-bit value of a specific register.
+ * @param handle The handle to the interpreter instance.
+ * @param registerIndex The index of the register (0-23).
+ * @param outValue Pointer to store the register value.
+ * @return MASM_OK on success, or an error code on failure.
+ */
+MASM_API MasmResult masm_get_register64(MasmInterpreterHandle handle, int registerIndex, int64_t* outValue);
+
+/**
+ * @brief Gets the register width of the loaded program.
+ * @param handle The handle to the interpreter instance.
+ * @param outBits Pointer to store 64 for a program compiled with --wide, else 32.
+ * @return MASM_OK on success, or an error code on failure.
+ */
+MASM_API MasmResult masm_get_register_width(MasmInterpreterHandle handle, int* outBits);
+
+/**
+ * @brief Copies all registers out of the interpreter.
+ * @param handle The handle to the interpreter instance.
+ * @param outRegisters Pointer to store the registers.
+ * @return MASM_OK on success, or an error code on failure.
+ */
+MASM_API MasmResult masm_get_registers(MasmInterpreterHandle handle, MasmRegisters* outRegisters);
+
+/**
+ * @brief Replaces all registers of the interpreter, e.g. to set up arguments before masm_execute.
+ * With 32-bit registers each value is truncated and sign-extended.
+ * @param handle The handle to the interpreter instance.
+ * @param registers The new register values.
+ * @return MASM_OK on success, or an error code on failure.
+ */
+MASM_API MasmResult masm_set_registers(MasmInterpreterHandle handle, const MasmRegisters* registers);
+
+/**
+ * @brief Gets the condition flags left by the last comparison.
+ * @param handle The handle to the interpreter instance.
+ * @param outZeroFlag Pointer to store ZF (0 or 1).
+ * @param outSignFlag Pointer to store SF (0 or 1).
+ * @return MASM_OK on success, or an error code on failure.
+ */
+MASM_API MasmResult masm_get_flags(MasmInterpreterHandle handle, int* outZeroFlag, int* outSignFlag);
+
 /**
  * @brief Reads an integer from the interpreter's RAM.
  * @param handle The handle to the interpreter instance.
@@ -80,6 +160,24 @@ MASM_API MasmResult masm_read_ram_int(MasmInterpreterHandle handle, int address,
  */
 MASM_API MasmResult masm_write_ram_int(MasmInterpreterHandle handle, int address, int32_t value);
 
+/**
+ * @brief Reads a 64-bit integer from the interpreter's RAM.
+ * @param handle The handle to the interpreter instance.
+ * @param address The RAM address to read from.
+ * @param outValue Pointer to store the read value.
+ * @return MASM_OK on success, or an error code on failure.
+ */
+MASM_API MasmResult masm_read_ram_int64(MasmInterpreterHandle handle, int address, int64_t* outValue);
+
+/**
+ * @brief Writes a 64-bit integer to the interpreter's RAM.
+ * @param handle The handle to the interpreter instance.
+ * @param address The RAM address to write to.
+ * @param value The value to write.
+ * @return MASM_OK on success, or an error code on failure.
+ */
+MASM_API MasmResult masm_write_ram_int64(MasmInterpreterHandle handle, int address, int64_t value);
+
 /**
  * @brief Gets the last error message set by an API call.
  * NOTE: This is often thread-unsafe in simple implementations.
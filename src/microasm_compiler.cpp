@@ -125,6 +125,11 @@ std::unordered_map<char, struct binary_search> token_search = {
     {'^', {'^', true, {(MathOperatorTokenType)0, 9}, {}}},
 };
 
+void Compiler::setWideRegisters(bool wide) {
+    wideRegisters = wide;
+    if (debugMode && wideRegisters) std::cout << "[Debug][Compiler] 64-bit registers enabled.\n";
+}
+
 void Compiler::setFlags(bool debug, bool write_dbg) {
     debugMode = debug;
     if (debugMode) std::cout << "[Debug][Compiler] Debug mode enabled.\n";
@@ -143,6 +148,20 @@ int getmin(int i)
     return 8;
 }
 
+// Bytes of an immediate in a --wide program. The interpreter zero-extends
+// values narrower than 4 bytes and sign-extends 4 byte ones, so only small
+// non-negative values can use the short forms.
+int wideImmediateSize(long long i)
+{
+    if (i >= 0 && i <= 0xFF)
+        return 1;
+    if (i >= 0 && i <= 0xFFFF)
+        return 2;
+    if (i == (int32_t)i)
+        return 4;
+    return 8;
+}
+
 int reverseDigits(int n) {
     int revNum = 0;
     while (n > 0) {
@@ -280,7 +299,7 @@ MathOperator getMathOperatorTokens(std::string op) {
     return ret;
 }
 
-int calculateOperandSize(std::string op) {
+int calculateOperandSize(std::string op, bool wide = false) {
     std::string op2 = op;
     if (op2[0] == '$') {
         op2.erase(0, 1);
@@ -297,6 +316,8 @@ int calculateOperandSize(std::string op) {
         } else {
             return 2 + getmin(data.other.val);
         }
+    } else if (wide) {
+        return wideImmediateSize(std::stoll(op2));
     } else {
         return getmin(std::stoi(op2));
     }
@@ -310,7 +331,7 @@ int Compiler::calculateInstructionSize(const Instruction& instr) {
         int size = 1; // Opcode
         size += instr.mniFunctionName.length() + 1; // Name + Null terminator
         for (auto& op : instr.operands) {
-            size += calculateOperandSize(op)+1;
+            size += calculateOperandSize(op, wideRegisters)+1;
         }
         size += 1; // End marker (Type + Value)
         return size;
@@ -319,7 +340,7 @@ int Compiler::calculateInstructionSize(const Instruction& instr) {
         int size = 1;
         for (int i=0; i<instr.operands.size(); i++) {
             std::string op = instr.operands[i];
-            size += 1 + calculateOperandSize(op);
+            size += 1 + calculateOperandSize(op, wideRegisters);
         }
         return size;
     }
@@ -571,18 +592,44 @@ void Compiler::parseLine(const std::string& line, int lineNumber) {
                         std::string addr = dataLabel;
                         addr.erase(0, 1);
                         int addre = std::stoi(addr);
-                        int size = processedValue.length() + 1;
-                        dataSegment.push_back(addre & 0xFF);
-                        dataSegment.push_back(addre >> 8);
-                        dataSegment.push_back(size & 0xFF);
-                        dataSegment.push_back(size >> 8);
-                        for(char c : processedValue) {
-                        dataSegment.push_back(c);
-                        }
-            dataSegment.push_back('\0'); // Null-terminate for convenience
+                        if (addre < 0)
+                            throw std::runtime_error("DB address cannot be negative: " + dataLabel);
+                        DataRecord record;
+                        record.address = addre;
+                        record.bytes.assign(processedValue.begin(), processedValue.end());
+            record.bytes.push_back('\0'); // Null-terminate for convenience
+            dataRecords.push_back(std::move(record));
             dataAddress += processedValue.length() + 1;
             if (debugMode) std::cout << "[Debug][Compiler]   Defined data label '" << dataLabel << " with value \"" << processedValue << "\"\n";
 
+        } else if (upperToken == "DT") {
+            // Jump table for JMPTAB: DT $addr #label0 #label1 ...
+            // Stored as an int32 entry count followed by the labels' code
+            // offsets, which compile() fills in once every label is known.
+            std::string dataLabel, label;
+            stream >> dataLabel;
+            if (dataLabel.size() < 2 || dataLabel[0] != '$')
+                throw std::runtime_error("DT requires a data address ($<number>): " + dataLabel);
+            int addre = std::stoi(dataLabel.substr(1));
+            JumpTable table;
+            while (stream >> label) {
+                if (label[0] != '#')
+                    throw std::runtime_error("DT entries must be labels (#name): " + label);
+                table.labels.push_back(label);
+            }
+            int count = table.labels.size();
+            if (addre < 0)
+                throw std::runtime_error("DT address cannot be negative: " + dataLabel);
+            DataRecord record;
+            record.address = addre;
+            for (int i = 0; i < 4; i++)
+                record.bytes.push_back((count >> (8 * i)) & 0xFF);
+            record.bytes.insert(record.bytes.end(), 4 * count, 0);
+            table.record = dataRecords.size();
+            dataRecords.push_back(std::move(record));
+            jumpTables.push_back(std::move(table));
+            if (debugMode) std::cout << "[Debug][Compiler]   Defined jump table '" << dataLabel << "' with " << count << " entries\n";
+
         } else if (upperToken == "MNI") {
             Instruction instr;
             instr.opcode = MNI;
@@ -645,10 +692,19 @@ Opcode Compiler::getOpcode(const std::string& mnemonic) {
         {"JNE", JNE}, {"JG", JG}, {"JLE", JLE}, {"JGE", JGE},
         {"ENTER", ENTER}, {"LEAVE", LEAVE},
         {"COPY", COPY}, {"FILL", FILL}, {"CMP_MEM", CMP_MEM},
-        {"MALLOC", MALLOC}, {"FREE", FREE},
+        {"MALLOC", MALLOC}, {"FREE", FREE}, {"SBRK", SBRK},
         {"MNI", MNI},
         {"IN", IN},
-        {"MOVB", MOVB}
+        {"MOVB", MOVB}, {"MOVW", MOVW}, {"MOVD", MOVD}, {"MOVQ", MOVQ},
+        {"LOOP", LOOP}, {"CJE", CJE}, {"CJNE", CJNE}, {"CJL", CJL}, {"CJG", CJG},
+        {"CJLE", CJLE}, {"CJGE", CJGE}, {"JMPTAB", JMPTAB},
+        {"VADDB", VADDB}, {"VADDW", VADDW}, {"VADDD", VADDD},
+        {"VSUBB", VSUBB}, {"VSUBW", VSUBW}, {"VSUBD", VSUBD},
+        {"VMULB", VMULB}, {"VMULW", VMULW}, {"VMULD", VMULD},
+        {"VMINB", VMINB}, {"VMINW", VMINW}, {"VMIND", VMIND},
+        {"VMAXB", VMAXB}, {"VMAXW", VMAXW}, {"VMAXD", VMAXD},
+        {"VSUMB", VSUMB}, {"VSUMW", VSUMW}, {"VSUMD", VSUMD},
+        {"VDOTB", VDOTB}, {"VDOTW", VDOTW}, {"VDOTD", VDOTD}
     };
     return opcodeMap.at(upperMnemonic);
 }
@@ -675,10 +731,40 @@ void Compiler::compile(const std::string& outputFile) {
     }
     // --- End check ---
 
+    // Fill in the DT tables now that every label has an address
+    for (const auto& table : jumpTables) {
+        for (size_t i = 0; i < table.labels.size(); i++) {
+            int32_t offset = resolveOperand(table.labels[i]).value;
+            for (int b = 0; b < 4; b++)
+                dataRecords[table.record].bytes[4 + 4 * i + b] = (offset >> (8 * b)) & 0xFF;
+        }
+    }
+
+    // Each record is its address and size, then its bytes. They are 16-bit
+    // unless a record needs more, which takes BINARY_FLAG_WIDE_DATA.
+    bool wideData = false;
+    for (const auto& record : dataRecords)
+        if (record.address > 0xFFFF || record.bytes.size() > 0xFFFF)
+            wideData = true;
+    int field = wideData ? 4 : 2;
+    std::vector<char> dataSegment;
+    for (const auto& record : dataRecords) {
+        uint32_t size = record.bytes.size();
+        for (int b = 0; b < field; b++)
+            dataSegment.push_back((record.address >> (8 * b)) & 0xFF);
+        for (int b = 0; b < field; b++)
+            dataSegment.push_back((size >> (8 * b)) & 0xFF);
+        dataSegment.insert(dataSegment.end(), record.bytes.begin(), record.bytes.end());
+    }
+
     // Prepare the header
     BinaryHeader header;
     header.magic = 0x4D53414D; // "MASM"
-    header.version = VERSION;
+    // Only programs with 64-bit registers or wide data records need version
+    // 3, the rest stay readable by version 2 interpreters
+    header.version = wideRegisters || wideData ? VERSION : 2;
+    header.flags = (wideRegisters ? BINARY_FLAG_WIDE_REGISTERS : 0) |
+                   (wideData ? BINARY_FLAG_WIDE_DATA : 0);
     header.codeSize = actualCodeSize;
     header.dataSize = dataSegment.size();
     header.dbgSize = 0;
@@ -714,7 +800,7 @@ void Compiler::compile(const std::string& outputFile) {
             for (const auto& operand : instr.operands) {
                 ResolvedOperand resolved = resolveOperand(operand, instr.opcode);
                 if (debugMode) std::cout << "[Debug][Compiler]     Operand Type: 0x" << std::hex << static_cast<int>(resolved.type) << ", Value: " << std::dec << resolved.value << " (0x" << std::hex << resolved.value << std::dec << ")\n";
-                int value_size = calculateOperandSize(operand);
+                int value_size = calculateOperandSize(operand, wideRegisters);
                 out.put(static_cast<char>(resolved.type) | (value_size << 4));
                 const char * value = reinterpret_cast<const char*>(&resolved.value);
                 for (int i=0; i<value_size; i++) {
@@ -731,7 +817,7 @@ void Compiler::compile(const std::string& outputFile) {
             for (const auto& operand : instr.operands) {
                 ResolvedOperand resolved = resolveOperand(operand, instr.opcode);
                 if (debugMode) std::cout << "[Debug][Compiler]     Operand Type: 0x" << std::hex << static_cast<int>(resolved.type) << ", Value: " << std::dec << resolved.value << " (0x" << std::hex << resolved.value << std::dec << ")\n";
-                int value_size = calculateOperandSize(operand);
+                int value_size = calculateOperandSize(operand, wideRegisters);
 
                 out.put(static_cast<char>(resolved.type) | ((value_size << 4) * -1 * resolved.size));
                 const char * value = reinterpret_cast<const char*>(&resolved.value);
@@ -826,7 +912,7 @@ ResolvedOperand Compiler::resolveOperand(const std::string& operand, Opcode cont
                     // Try parsing as an immediate number (e.g., $500)
                     try {
                         long long val = std::stoll(numStr);
-                        if (val < INT_MIN || val > INT_MAX) {
+                        if (!wideRegisters && (val < INT_MIN || val > INT_MAX)) {
                             throw std::runtime_error("Immediate value ($) out of 32-bit range: " + operand);
                         }
                         result.type = OperandType::IMMEDIATE;
@@ -875,11 +961,11 @@ ResolvedOperand Compiler::resolveOperand(const std::string& operand, Opcode cont
         } else { // Immediate value (not starting with $ or # or R)
             try {
                 long long val = std::stoll(operand);
-                if (val < INT_MIN || val > INT_MAX) {
+                if (!wideRegisters && (val < INT_MIN || val > INT_MAX)) {
                     throw std::runtime_error("Immediate value out of 32-bit range: " + operand);
                 }
                 result.type = OperandType::IMMEDIATE;
-                result.value = static_cast<int>(val);
+                result.value = wideRegisters ? val : static_cast<int>(val);
             } catch (...) { // Catch invalid_argument, out_of_range
                 throw std::runtime_error("Invalid immediate value or unknown operand: " + operand);
             }
@@ -902,6 +988,7 @@ int microasm_compiler_main(int argc, char* argv[]) {
     std::string outputFile;
     bool enableDebug = false;
     bool write_dbg_data = false;
+    bool wideRegisters = false;
     std::vector<char*> filtered_args; // Store non-debug args for potential future use
 
     // argv[0] here is the *first argument* after "-c", not the program name
@@ -912,6 +999,8 @@ int microasm_compiler_main(int argc, char* argv[]) {
         } else if (arg == "-g" || arg == "--dbg_data") {
             std::cout << "WARNING: Debug data being written to file" << std::endl;
             write_dbg_data = true;
+        } else if (arg == "-w" || arg == "--wide") {
+            wideRegisters = true;
         } else if (sourceFile.empty()) {
             sourceFile = arg;
             filtered_args.push_back(argv[i]);
@@ -925,7 +1014,7 @@ int microasm_compiler_main(int argc, char* argv[]) {
     }
 
     if (sourceFile.empty() || outputFile.empty()) {
-        std::cerr << "Compiler Usage: <source.masm> <output.bin> [debug.masmd] [-d|--debug]" << std::endl;
+        std::cerr << "Compiler Usage: <source.masm> <output.bin> [debug.masmd] [-d|--debug] [-w|--wide]" << std::endl;
         return 1;
     }
     // --- End Argument Parsing ---
@@ -942,6 +1031,7 @@ int microasm_compiler_main(int argc, char* argv[]) {
 
         Compiler compiler;
         compiler.setFlags(enableDebug, write_dbg_data); // Set debug mode
+        compiler.setWideRegisters(wideRegisters);
         compiler.parse(buffer.str());       // Parse content
         compiler.compile(outputFile);       // Compile to output
 
@@ -8,7 +8,7 @@
 #include "common_defs.h"   // Include common definitions (Opcode, BinaryHeader)
 #include "operand_types.h" // Include operand types
 
-#define VERSION 2
+#define VERSION 3
 
 // Define Instruction struct here
 struct Instruction {
@@ -37,11 +37,24 @@ struct binary_search {
 class Compiler {
     std::unordered_map<std::string, int> labelMap;
     std::vector<Instruction> instructions; // Now knows what Instruction is
-    std::vector<char> dataSegment;
+    // DB strings and DT tables, written by compile() as the data segment
+    struct DataRecord {
+        int address;
+        std::vector<char> bytes;
+    };
+    std::vector<DataRecord> dataRecords;
+    // DT tables: which record holds their entries and the labels to fill in
+    // once every label is known
+    struct JumpTable {
+        size_t record;
+        std::vector<std::string> labels;
+    };
+    std::vector<JumpTable> jumpTables;
     int currentAddress = 0;
     int dataAddress = 0;
     bool debugMode = false;
     bool write_dbg_data = true;
+    bool wideRegisters = false; // 64-bit registers, written as a version 3 binary
 
     // Include directive handling
     std::set<std::string> includedFiles;
@@ -60,6 +73,7 @@ class Compiler {
 
 public:
     void setFlags(bool debug=false, bool write_dbg=false);
+    void setWideRegisters(bool wide);
     void parse(const std::string& source);
     void compile(const std::string& outputFile);
 };
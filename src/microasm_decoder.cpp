@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <cctype>
 #include <cstring>
+#include <algorithm>
 #include "common_defs.h"
 //#include "microasm_compiler.h"
 
@@ -35,7 +36,17 @@ const std::unordered_map<Opcode, std::string> opcodeToString = {
     {ENTER, "ENTER"}, {LEAVE, "LEAVE"},
     {COPY, "COPY"}, {FILL, "FILL"}, {CMP_MEM, "CMP_MEM"},
     {MNI, "MNI"}, {IN, "IN"}, 
-    {MALLOC, "MALLOC"}, {FREE, "FREE"}
+    {MALLOC, "MALLOC"}, {FREE, "FREE"}, {SBRK, "SBRK"},
+    {MOVB, "MOVB"}, {MOVW, "MOVW"}, {MOVD, "MOVD"}, {MOVQ, "MOVQ"},
+    {LOOP, "LOOP"}, {CJE, "CJE"}, {CJNE, "CJNE"}, {CJL, "CJL"}, {CJG, "CJG"},
+    {CJLE, "CJLE"}, {CJGE, "CJGE"}, {JMPTAB, "JMPTAB"},
+    {VADDB, "VADDB"}, {VADDW, "VADDW"}, {VADDD, "VADDD"},
+    {VSUBB, "VSUBB"}, {VSUBW, "VSUBW"}, {VSUBD, "VSUBD"},
+    {VMULB, "VMULB"}, {VMULW, "VMULW"}, {VMULD, "VMULD"},
+    {VMINB, "VMINB"}, {VMINW, "VMINW"}, {VMIND, "VMIND"},
+    {VMAXB, "VMAXB"}, {VMAXW, "VMAXW"}, {VMAXD, "VMAXD"},
+    {VSUMB, "VSUMB"}, {VSUMW, "VSUMW"}, {VSUMD, "VSUMD"},
+    {VDOTB, "VDOTB"}, {VDOTW, "VDOTW"}, {VDOTD, "VDOTD"}
 };
 
 const std::unordered_map<int, std::string> registerIndexToString = {
@@ -173,15 +184,21 @@ void printHexBytes(const std::vector<uint8_t>& vec, size_t start, size_t end) {
 int getOperandCount(Opcode opcode) {
     switch (opcode) {
         case MOV: case ADD: case SUB: case MUL: case DIV: case CMP: case AND: case OR: case XOR: case SHL: case SHR:
+        case MOVB: case MOVW: case MOVD: case MOVQ: case LOOP: case JMPTAB:
+        case VSUMB: case VSUMW: case VSUMD:
         case GETARG: case COPY: case FILL: case CMP_MEM: case OUT: case COUT: case OUTCHAR:
             return 2;
         case OUTSTR: case MOVTO: case MOVADDR:
+        case CJE: case CJNE: case CJL: case CJG: case CJLE: case CJGE:
+        case VADDB: case VADDW: case VADDD: case VSUBB: case VSUBW: case VSUBD:
+        case VMULB: case VMULW: case VMULD: case VMINB: case VMINW: case VMIND:
+        case VMAXB: case VMAXW: case VMAXD: case VDOTB: case VDOTW: case VDOTD:
             return 3;
         case INC: case JMP: case JE: case JL: case CALL: case PUSH: case POP: case JNE: case JG: case JLE: case JGE: case ENTER: case ARGC: case IN:
             return 1;
         case RET: case LEAVE: case HLT:
             return 0;
-        case MALLOC: case FREE:
+        case MALLOC: case FREE: case SBRK:
             return 2;
         case MNI:
             return -1; // special
@@ -190,7 +207,7 @@ int getOperandCount(Opcode opcode) {
     }
 }
 
-int getOperandSize(char type) {
+int getOperandSize(uint8_t type) {
     if (type == '\0') {
         return 0;
     }
@@ -304,6 +321,12 @@ int decoder_main(int argc, char* argv[]) {
                   << (char)((header.magic >> 16) & 0xFF)
                   << (char)((header.magic >> 24) & 0xFF) << "')" << std::endl;
         std::cout << "Version:    " << header.version << std::endl;
+        std::cout << "Flags:      0x" << std::hex << header.flags << std::dec;
+        if (header.version >= 3 && (header.flags & BINARY_FLAG_WIDE_REGISTERS))
+            std::cout << " (64-bit registers)";
+        if (header.version >= 3 && (header.flags & BINARY_FLAG_WIDE_DATA))
+            std::cout << " (32-bit data records)";
+        std::cout << std::endl;
         std::cout << "Code Size:  " << header.codeSize << " bytes" << std::endl;
         std::cout << "Data Size:  " << header.dataSize << " bytes" << std::endl;
         std::cout << "Dbg  Size:  " << header.dbgSize << " bytes" << std::endl;
@@ -332,6 +355,7 @@ int decoder_main(int argc, char* argv[]) {
             throw std::runtime_error("Failed to read code segment.");
 
         std::set<uint32_t> referencedDataOffsets;
+        std::set<uint32_t> jumpTableOffsets;
         std::cout << "--- Code Segment (Size: " << header.codeSize << ") ---" << std::endl;
         std::cout << "Offset  | Bytes                          | Disassembly" << std::endl;
         std::cout << "--------|--------------------------------|--------------------------------" << std::endl;
@@ -382,12 +406,10 @@ int decoder_main(int argc, char* argv[]) {
                         OperandType t = static_cast<OperandType>(code[tempIp++] & 0b1111);
                         if (code[tempIp-1] == 6) t = (OperandType)(t + (1 << 4));
 
-                        long long       v =  (code[tempIp]);
-                        if (size >= 2) {v += (code[tempIp+1] << 8);}
-                        if (size >= 3) {v += (code[tempIp+2] << 16);}
-                        if (size >= 4) {v += (code[tempIp+3] << 24);}
-                        if (size >= 5) {v += ((long long)code[tempIp+4] << 32);}
-                        if (size == 6) {v += ((long long)code[tempIp+5] << 40);}
+                        long long v = 0;
+                        for (int b = 0; b < size; b++)
+                            v |= (long long)code[tempIp + b] << (8 * b);
+                        if (size == 4) v = (int32_t)v; // Sign-extended like the interpreter
 
                         //if (size != 4) v = v & (1<<(8*(size)))-1;
                         tempIp += size;
@@ -401,6 +423,8 @@ int decoder_main(int argc, char* argv[]) {
             } catch (...) {
                 unknown = true;
             }
+            if (opcode == JMPTAB && operands.size() == 2 && operands[1].first == DATA_ADDRESS)
+                jumpTableOffsets.insert(operands[1].second);
 
             if (lbls.count(startIp)) {
                 std::cout << CLR_OFFSET 
@@ -475,12 +499,37 @@ int decoder_main(int argc, char* argv[]) {
         char* mem_data = (char*)malloc(header.dataSize * sizeof(char));
         char* tmp_data = mem_data;
         in.read(mem_data, header.dataSize);
-        while (mem_data < tmp_data+header.dataSize) {
-            int16_t addr = *(int16_t*)&mem_data[0];
-            int16_t size = *(int16_t*)&mem_data[2];
-            mem_data += 4;
+        size_t field = header.version >= 3 && (header.flags & BINARY_FLAG_WIDE_DATA) ? 4 : 2;
+        while (mem_data + 2 * field <= tmp_data+header.dataSize) {
+            uint32_t addr = 0, size = 0;
+            memcpy(&addr, &mem_data[0], field);
+            memcpy(&size, &mem_data[field], field);
+            mem_data += 2 * field;
             std::string data_string;
             std::string ins = "DB $" + std::to_string((int)addr) + " \"" + repr(mem_data) + "\"";
+            // A JMPTAB table is a count followed by that many code offsets,
+            // write it back as the DT it was compiled from. Entries are named
+            // like the lbl lines the decompiled output gets for them.
+            int32_t count = 0;
+            if (jumpTableOffsets.count(addr) && size >= 4 && mem_data + size <= tmp_data + header.dataSize)
+                memcpy(&count, mem_data, 4);
+            if (count > 0 && size == 4 + 4 * (uint32_t)count) {
+                ins = "DT $" + std::to_string((int)addr);
+                for (int32_t i = 0; i < count; i++) {
+                    int32_t target = 0;
+                    memcpy(&target, &mem_data[4 + 4 * i], 4);
+                    labels.push_back(target);
+                    auto line = addr_to_line.find(target);
+                    if (header.dbgSize != 0 && lbls.count(target))
+                        ins += " " + lbls.at(target);
+                    else if (header.dbgSize == 0 && line != addr_to_line.end() && line->second == entry_line)
+                        ins += " #main";
+                    else if (header.dbgSize == 0 && line != addr_to_line.end())
+                        ins += " #label_" + std::to_string(std::find(labels.begin(), labels.end(), target) - labels.begin());
+                    else
+                        ins += " #" + std::to_string(target);
+                }
+            }
             std::cout << ins << std::endl;
             instructions.push_back(ins);
             mem_data += size;
@@ -525,6 +574,8 @@ int decoder_main(int argc, char* argv[]) {
 
         if (argc >= 2) {
             std::string decompiled;
+            if (header.version >= 3 && (header.flags & BINARY_FLAG_WIDE_REGISTERS))
+                decompiled += "; 64-bit registers, compile with --wide\n";
             for (int i=0;i<instructions.size();i++) {
                 std::string ins = instructions[i];
                 if (header.dbgSize != 0) {
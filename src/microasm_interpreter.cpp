@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -7,6 +9,7 @@
 #include <iostream>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <sstream> // Add this header for std::stringstream
 #include <stack>
 #include <stdexcept>
@@ -14,9 +17,25 @@
 #include <vector>
 #include "heap.h"
 #include "microasm_compiler.h"
+#include "microasm_vector.h"
 #include "operand_types.h"
 std::vector<std::string> mniCallStack;
-#define VERSION 2
+#define VERSION 3
+
+// Labels-as-values dispatch needs GCC or Clang; anything else gets the switch.
+#if defined(MASM_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define MASM_USE_THREADED_DISPATCH 1
+#else
+#define MASM_USE_THREADED_DISPATCH 0
+#endif
+// RAM addressing: with MASM_MASKED_RAM addresses are wrapped into a
+// power-of-two buffer instead of being bounds checked, see maskedRam().
+#ifdef MASM_MASKED_RAM
+#define MASM_USE_MASKED_RAM 1
+#else
+#define MASM_USE_MASKED_RAM 0
+#endif
+
 // Include own header FIRST
 #include "microasm_interpreter.h"
 
@@ -25,7 +44,91 @@ std::map<std::string, MniFunctionType> mniRegistry;
 
 std::unordered_map<int, std::string> lbls; // known labels
 
-void Interpreter::writeToOperand(BytecodeOperand op, int val, int size) {
+// Record a fault for the execute loop to pick up. The first fault wins, so a
+// handler can make several calls and check once.
+inline void Interpreter::setFault(Fault code, long long value) {
+    if (fault == Fault::NONE) {
+        fault = code;
+        faultValue = value;
+    }
+}
+
+std::string Interpreter::faultMessage() const {
+    switch (fault) {
+        case Fault::NONE:
+            return "No fault";
+        case Fault::MEMORY_READ:
+            return "Memory read out of bounds at address: " + std::to_string(faultValue);
+        case Fault::MEMORY_WRITE:
+            return "Memory write out of bounds at address: " + std::to_string(faultValue);
+        case Fault::INVALID_REGISTER:
+            return "Invalid register index encountered: " + std::to_string(faultValue);
+        case Fault::NOT_A_REGISTER:
+            return "Expected register operand, got type " + std::to_string(faultValue);
+        case Fault::NO_RAM_ADDRESS:
+            return "Cannot get ram address for register/immediate";
+        case Fault::BAD_OPERAND_TYPE:
+            return "Cannot get value for unknown or invalid operand type: " +
+                   std::to_string(faultValue);
+        case Fault::BAD_MATH_OPERATOR:
+            return "uhhhhhhh";
+        case Fault::BAD_JUMP_TARGET:
+            return "Jump target is not an instruction boundary: " + std::to_string(faultValue);
+        case Fault::MEMORY_BOUNDS:
+            return "Memory access out of bounds";
+        case Fault::STACK_UNDERFLOW:
+            return "Stack underflow on RET";
+        case Fault::DIVISION_BY_ZERO:
+            return "Division by zero";
+        case Fault::MESSAGE:
+            return faultText;
+    }
+    return "Unknown fault";
+}
+
+// Turn a fault recorded outside the execute loop (public helpers used by MNI
+// functions and the C API) into the exception those callers expect.
+void Interpreter::raiseFault() {
+    std::string message = faultMessage();
+    fault = Fault::NONE;
+    throw std::runtime_error(message);
+}
+
+// A 64-bit register value used as a RAM address. Anything outside the int
+// range becomes -1, which the RAM helpers reject like any other bad address.
+static inline int ramAddress(int64_t value) {
+    return value == (int)value ? (int)value : -1;
+}
+
+// Bytes moved by MOVB/MOVW/MOVD/MOVQ
+static inline int moveWidth(uint8_t opcode) {
+    switch (opcode) {
+        case MOVB: return 1;
+        case MOVW: return 2;
+        case MOVD: return 4;
+        default: return 8;
+    }
+}
+
+// Vector instructions come in B/W/D triples: VADDB, VADDW, VADDD, VSUBB, ...
+static inline int vectorWidth(uint8_t opcode) {
+    return 1 << ((opcode - VADDB) % 3);
+}
+
+// Two's complement arithmetic on register values; the narrow results are cut
+// back to 32 bits by toRegister() when stored.
+static inline int64_t wrapAdd(int64_t a, int64_t b) {
+    return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+static inline int64_t wrapSub(int64_t a, int64_t b) {
+    return (int64_t)((uint64_t)a - (uint64_t)b);
+}
+static inline int64_t wrapMul(int64_t a, int64_t b) {
+    return (int64_t)((uint64_t)a * (uint64_t)b);
+}
+
+template <bool Checked>
+void Interpreter::writeToOperand(const BytecodeOperand &op, int64_t val, int size) {
     switch (op.type)
     {
         case OperandType::LABEL_ADDRESS:
@@ -34,37 +137,45 @@ void Interpreter::writeToOperand(BytecodeOperand op, int val, int size) {
             std::cerr << "Attempted to write to a immediate value" << std::endl;
             break;
         
-        case OperandType::REGISTER:
-            registers[getRegisterIndex(op)] = val;
+        case OperandType::REGISTER: {
+            int index = registerIndex<Checked>(op);
+            if (index >= 0)
+                registers[index] = toRegister(val);
             break;
+        }
 
         case OperandType::REGISTER_AS_ADDRESS:
         case OperandType::MATH_OPERATOR:
-        case OperandType::DATA_ADDRESS:
-            writeRamNum(getRamAddr(op), val, size);
+        case OperandType::DATA_ADDRESS: {
+            int address = getRamAddr(op);
+            if (fault == Fault::NONE)
+                storeRamNum(address, val, size);
             break;
+        }
     }
 }
 
-int Interpreter::getRamAddr(BytecodeOperand op) {
+int Interpreter::getRamAddr(const BytecodeOperand &op) {
     switch (op.type)
     {
         case OperandType::LABEL_ADDRESS:
         case OperandType::IMMEDIATE:
         case OperandType::NONE:
         case OperandType::REGISTER:
-            throw std::runtime_error("Cannot get ram address for register/immediate");
-            break;
+            setFault(Fault::NO_RAM_ADDRESS);
+            return 0;
 
         case OperandType::REGISTER_AS_ADDRESS:
-            return registers[op.value];
+            return ramAddress(registers[op.value]);
 
         case OperandType::DATA_ADDRESS:
             return op.value;
         case OperandType::MATH_OPERATOR:
-            return getAdvancedAddr(op);
+            return mathOperatorAddr(op);
     }
-    throw std::runtime_error("Cannot get ram address for unknown");
+    faultText = "Cannot get ram address for unknown";
+    setFault(Fault::MESSAGE);
+    return 0;
 }
 
 // Define the MNI registration function
@@ -85,30 +196,53 @@ void registerMNI(const std::string &module, const std::string &name,
 
 Interpreter::Interpreter(int ramSize, const std::vector<std::string> &args,
                          bool debug, bool trace)
-    : registers(24, 0), ram(ramSize, 0), cmdArgs(args), debugMode(debug),
+    : ram(ramSize), cmdArgs(args), debugMode(debug),
       stackTrace(trace) {
+    ramBytes = ram.size();
+#if MASM_USE_MASKED_RAM
+    // Round up to a power of two and add the guard area behind it
+    ramBytes = 1;
+    while (ramBytes < (size_t)ramSize)
+        ramBytes <<= 1;
+    ramMask = ramBytes - 1;
+    ram.assign(ramBytes + RAM_GUARD_SIZE);
+#endif
     // Initialize Stack Pointer (RSP, index 7) to top of RAM
-    registers[7] = ramSize;
-    sp = registers[7];
+    registers[7] = ramBytes;
     // Base Pointer (RBP, index 6) is initalized to zero. Normal this will be
     // set to junk but we can set it to zero.
     registers[6] = 0;
-    bp = registers[6];
     // Set data segment base - let's put it in the middle for now
     // Ensure this doesn't collide with stack growing down!
 
-    // Initialize MNI functions
-    initializeMNIFunctions();
+    // Initialize MNI functions. The registry is shared by every interpreter
+    // in the process, so the built-ins are registered once.
+    static std::once_flag mniBuiltins;
+    std::call_once(mniBuiltins, [this] { initializeMNIFunctions(); });
 
-    // Initialize Heap
-    heap_init();
+    // Initialize Heap, load() moves it above the data records
+    initHeap(0);
+
+    // Nothing to run until load()
+    static const auto nothingLoaded = std::make_shared<const LoadedProgram>();
+    loaded = nothingLoaded;
 
     if (debugMode)
         std::cout << "[Debug][Interpreter] Debug mode enabled. RAM Size: "
                   << ramSize << "\n";
 }
 
-int Interpreter::getOperandSize(char type) {
+std::unique_ptr<Interpreter> Interpreter::clone() {
+    std::unique_ptr<Interpreter> copy(new Interpreter(*this));
+    // Native blocks belong to this Jit, so the clone starts from the handlers
+    // load() chose and sets up its own hot counters
+    copy->fastHandlers = loaded->fast;
+    ram.cloneTo(copy->ram);
+    copy->heap.heap_copy(heap, copy->ram.data());
+    return copy;
+}
+
+int Interpreter::getOperandSize(uint8_t type) {
     if (type == '\0') {
         return 1;
     }
@@ -121,55 +255,39 @@ int Interpreter::getOperandSize(char type) {
 }
 
 BytecodeOperand Interpreter::nextRawOperand() {
-    int size = getOperandSize(bytecode_raw[ip]);
-    if (ip + 1 + size >
-        bytecode_raw.size()) { // Check size for type byte + value int
+    // Past the end ip points into the zero padding, which reads as a one
+    // byte NONE operand, so one check covers the type byte and the value.
+    uint8_t typeByte = bytecode_raw[ip];
+    int size = getOperandSize(typeByte);
+    if (ip + 1 + size > codeSize) { // Check size for type byte + value int
         throw std::runtime_error(
             "Unexpected end of bytecode reading typed operand (IP: " +
             std::to_string(ip) +
-            ", CodeSize: " + std::to_string(bytecode_raw.size()) + ")");
+            ", CodeSize: " + std::to_string(codeSize) + ")");
     }
     BytecodeOperand operand;
-    operand.type = static_cast<OperandType>(bytecode_raw[ip++] & 15);
-    // Handle NONE type immediately if needed (though it shouldn't be read here
-    // usually)
+    operand.type = static_cast<OperandType>(typeByte & 15);
+    ip++;
+    // NONE is just the type byte (the MNI argument list terminator)
     if (operand.type == OperandType::NONE) {
-        operand.value = 0; // No value associated
-        // ip adjustment might depend on how NONE is encoded (e.g., if it has a
-        // dummy value) Assuming it's just the type byte based on compiler code
-        // for MNI marker
+        operand.value = 0;
     } else {
-        if (bytecode_raw[ip-1] == 6) {
-            operand.use_reg = true;
-        }
-        if (ip + size > bytecode_raw.size()) {
-            throw std::runtime_error(
-                "Unexpected end of bytecode reading operand value (IP: " +
-                std::to_string(ip) + ")");
-        }
-                        operand.value =  (bytecode_raw[ip]);
-        if (size >= 2) {operand.value += (bytecode_raw[ip+1] << 8);}
-        if (size >= 3) {operand.value += (bytecode_raw[ip+2] << 16);}
-        if (size >= 4) {operand.value += (bytecode_raw[ip+3] << 24);}
-        if (size >= 5) {operand.value += ((long long)bytecode_raw[ip+4] << 32);}
-        if (size == 6) {operand.value += ((long long)bytecode_raw[ip+5] << 40);}
-
-        if (size != 4)
-            operand.value &= (1 << (8 * size)) - 1;
+        operand.use_reg = typeByte == 6;
+        operand.value = readOperandValue(&bytecode_raw[ip], size);
         ip += size;
     }
     return operand;
 }
 
-int Interpreter::getAdvancedAddr(BytecodeOperand operand) {
+int Interpreter::mathOperatorAddr(const BytecodeOperand &operand) {
     long long data = operand.value;
     int reg = data & 0xFF;
     MathOperatorOperators math_op = (MathOperatorOperators)(data >> 8 & 0xFF);
     int other_val = data >> 16;
-    int v1 = registers[reg];
-    int v2;
+    int64_t v1 = registers[reg];
+    int64_t v2;
     if (operand.use_reg) v2 = registers[other_val]; else v2 = other_val;
-    int ret = 0;
+    int64_t ret = 0;
     switch (math_op)
     {
         case op_ADD:
@@ -212,134 +330,304 @@ int Interpreter::getAdvancedAddr(BytecodeOperand operand) {
             ret = v2 << v1;
             break;
         case op_NONE:
-            throw std::runtime_error("uhhhhhhh");
+            setFault(Fault::BAD_MATH_OPERATOR);
             break;
     }
-    return ret;
+    return ramAddress(ret);
 } 
 
-int Interpreter::getValue(const BytecodeOperand &operand, int size) {
+int Interpreter::getAdvancedAddr(const BytecodeOperand operand) {
+    int address = mathOperatorAddr(operand);
+    if (fault != Fault::NONE)
+        raiseFault();
+    return address;
+}
+
+template <bool Checked>
+int64_t Interpreter::loadValue(const BytecodeOperand &operand, int size) {
     switch (operand.type) {
         case OperandType::LABEL_ADDRESS:
         case OperandType::IMMEDIATE:
         case OperandType::NONE:
             return operand.value;
-            break;
         
-        case OperandType::REGISTER:
-            return registers[getRegisterIndex(operand)];
-            break;
+        case OperandType::REGISTER: {
+            int index = registerIndex<Checked>(operand);
+            return index >= 0 ? registers[index] : 0;
+        }
 
         case OperandType::REGISTER_AS_ADDRESS:
         case OperandType::MATH_OPERATOR:
-        case OperandType::DATA_ADDRESS:
-            return readRamNum(getRamAddr(operand), size);
-            break;
+        case OperandType::DATA_ADDRESS: {
+            int address = getRamAddr(operand);
+            return fault == Fault::NONE ? loadRamNum(address, size) : 0;
+        }
 
     default:
-        throw std::runtime_error(
-            "Cannot get value for unknown or invalid operand type: " +
-            std::to_string(static_cast<int>(operand.type)));
+        setFault(Fault::BAD_OPERAND_TYPE, static_cast<int>(operand.type));
+        return 0;
     }
 }
 
-int Interpreter::getRegisterIndex(const BytecodeOperand &operand) {
+int64_t Interpreter::getValue(const BytecodeOperand &operand, int size) {
+    int64_t value = loadValue(operand, size);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
+    return value;
+}
+
+template <bool Checked>
+int Interpreter::registerIndex(const BytecodeOperand &operand) {
     if (operand.type != OperandType::REGISTER) {
-        throw std::runtime_error(
-            "Expected register operand, got type " +
-            std::to_string(static_cast<int>(operand.type)));
+        setFault(Fault::NOT_A_REGISTER, static_cast<int>(operand.type));
+        return -1;
     }
-    if (operand.value < 0 || operand.value >= registers.size()) {
-        throw std::runtime_error("Invalid register index encountered: " +
-                                 std::to_string(operand.value));
+    if (Checked && (operand.value < 0 || operand.value >= registers.size())) {
+        setFault(Fault::INVALID_REGISTER, operand.value);
+        return -1;
     }
     return operand.value;
 }
 
-int Interpreter::readRamInt(int address) {
+int Interpreter::getRegisterIndex(const BytecodeOperand &operand) {
+    int index = registerIndex(operand);
+    if (index < 0)
+        raiseFault();
+    return index;
+}
+
+// Masked RAM: the bytes of a `width` byte access at `address`, wrapped into
+// the buffer. Instead of branching on the bounds, any bit of the access's last
+// byte above the mask is or'ed into ramOutOfBounds for the execute loop to
+// check at the end of the block (see CHECK_RAM). Width is at most
+// RAM_GUARD_SIZE, so the access never leaves the buffer.
+inline char *Interpreter::maskedRam(int address, int width) {
+    ramOutOfBounds |= ((uint64_t)(uint32_t)address + width - 1) & ~(uint64_t)ramMask;
+    return &ram[(uint32_t)address & ramMask];
+}
+
+// Masked RAM: turn the sticky out-of-range flag into a fault
+void Interpreter::collectRamFault() {
+    if (ramOutOfBounds) {
+        ramOutOfBounds = 0;
+        setFault(Fault::MEMORY_BOUNDS);
+    }
+}
+
+int Interpreter::loadRamInt(int address) {
+#if MASM_USE_MASKED_RAM
+    return *reinterpret_cast<int *>(maskedRam(address, sizeof(int)));
+#else
     if (address < 0 || address + sizeof(int) > ram.size()) {
-        throw std::runtime_error("Memory read out of bounds at address: " +
-                                 std::to_string(address));
+        setFault(Fault::MEMORY_READ, address);
+        return 0;
     }
     return *reinterpret_cast<int *>(&ram[address]);
+#endif
 }
 
-void Interpreter::writeRamInt(int address, int value) {
+void Interpreter::storeRamInt(int address, int value) {
+#if MASM_USE_MASKED_RAM
+    *reinterpret_cast<int *>(maskedRam(address, sizeof(int))) = value;
+#else
     if (address < 0 || address + sizeof(int) > ram.size()) {
-        throw std::runtime_error("Memory write out of bounds at address: " +
-                                 std::to_string(address));
+        setFault(Fault::MEMORY_WRITE, address);
+        return;
     }
     *reinterpret_cast<int *>(&ram[address]) = value;
+#endif
 }
 
-
-int Interpreter::readRamNum(int address, int size) {
-    if (address < 0 || address + sizeof(int) > ram.size()) {
-        throw std::runtime_error("Memory read out of bounds at address: " +
-                                 std::to_string(address));
+// Little-endian values of `size` bytes (at most RAM_GUARD_SIZE) in RAM. As
+// with operands, 4 byte values are sign-extended ints and narrower ones
+// zero-extended.
+int64_t Interpreter::loadRamNum(int address, int size) {
+#if MASM_USE_MASKED_RAM
+    const char *bytes = maskedRam(address, size);
+#else
+    if (address < 0 || address + (size_t)size > ramBytes) {
+        setFault(Fault::MEMORY_READ, address);
+        return 0;
+    }
+    const char *bytes = &ram[address];
+#endif
+    switch (size) {
+        case 1:
+            return (uint8_t)bytes[0];
+        case 4: {
+            int32_t value;
+            std::memcpy(&value, bytes, 4);
+            return value;
+        }
+        case 8: {
+            int64_t value;
+            std::memcpy(&value, bytes, 8);
+            return value;
+        }
+        default: {
+            uint64_t value = 0;
+            std::memcpy(&value, bytes, size);
+            return (int64_t)value;
+        }
     }
-    unsigned int    ret =  (unsigned char)(ram[address]);
-    if (size >= 2) {ret += (ram[address+1] << 8);}
-    if (size >= 3) {ret += (ram[address+2] << 16);}
-    if (size >= 4) {ret += (ram[address+3] << 24);}
-    return (int)ret;
 }
 
-void Interpreter::writeRamNum(int address, int value, int size) {
-    if (address < 0 || address + sizeof(int) > ram.size()) {
-        throw std::runtime_error("Memory write out of bounds at address: " +
-                                 std::to_string(address));
+void Interpreter::storeRamNum(int address, int64_t value, int size) {
+#if MASM_USE_MASKED_RAM
+    char *bytes = maskedRam(address, size);
+#else
+    if (address < 0 || address + (size_t)size > ramBytes) {
+        setFault(Fault::MEMORY_WRITE, address);
+        return;
+    }
+    char *bytes = &ram[address];
+#endif
+    switch (size) {
+        case 1:
+            bytes[0] = (char)value;
+            break;
+        case 4: {
+            int32_t narrow = (int32_t)value;
+            std::memcpy(bytes, &narrow, 4);
+            break;
+        }
+        case 8:
+            std::memcpy(bytes, &value, 8);
+            break;
+        default:
+            std::memcpy(bytes, &value, size);
+            break;
     }
-                    ram[address] = value & 0xFF;
-    if (size >= 2) {ram[address+1] = (value << 8) & 0xFF;}
-    if (size >= 3) {ram[address+2] = (value << 16) & 0xFF;}
-    if (size >= 4) {ram[address+3] = (value << 24) & 0xFF;}
 }
 
-char Interpreter::readRamChar(int address) {
+char Interpreter::loadRamChar(int address) {
+#if MASM_USE_MASKED_RAM
+    return *maskedRam(address, 1);
+#else
     if (address < 0 || address >= ram.size()) {
-        throw std::runtime_error("Memory read out of bounds at address: " +
-                                 std::to_string(address));
+        setFault(Fault::MEMORY_READ, address);
+        return 0;
     }
     return ram[address];
+#endif
+}
+
+std::string Interpreter::loadRamString(int address) {
+    std::string str = "";
+    int currentAddr = address;
+    while (true) {
+        char c = loadRamChar(currentAddr++);
+        // Masked RAM would wrap around instead of faulting at the end
+        if (c == '\0' || ramOutOfBounds)
+            break;
+        str += c;
+    }
+    return str;
+}
+
+int Interpreter::readRamInt(int address) {
+    int value = loadRamInt(address);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
+    return value;
+}
+
+void Interpreter::writeRamInt(int address, int value) {
+    ram.touch();
+    storeRamInt(address, value);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
+}
+
+int64_t Interpreter::readRamNum(int address, int size) {
+    int64_t value = loadRamNum(address, size);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
+    return value;
+}
+
+void Interpreter::writeRamNum(int address, int64_t value, int size) {
+    ram.touch();
+    storeRamNum(address, value, size);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
+}
+
+char Interpreter::readRamChar(int address) {
+    char value = loadRamChar(address);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
+    return value;
 }
 
 void Interpreter::writeRamChar(int address, char value) {
-    if (address < 0 || address >= ram.size()) {
+    if (address < 0 || address >= ramBytes) {
         throw std::runtime_error("Memory write out of bounds at address: " +
                                  std::to_string(address));
     }
+    ram.touch();
     ram[address] = value;
 }
 
 std::string Interpreter::readRamString(int address) {
-    std::string str = "";
-    int currentAddr = address;
-    while (true) {
-        char c = readRamChar(currentAddr++);
-        if (c == '\0')
-            break;
-        str += c;
-    }
+    std::string str = loadRamString(address);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
     return str;
 }
 
-void Interpreter::pushStack(int value) {
-    registers[7] -= sizeof(int); // Decrement RSP (stack grows down)
-    sp = registers[7];
-    writeRamInt(sp, value);
+// Stack slots are one register value, wordSize bytes
+void Interpreter::stackPush(int64_t value) {
+    registers[7] -= wordSize; // Decrement RSP (stack grows down)
+    if (wideRegisters)
+        storeRamNum(ramAddress(registers[7]), value, 8);
+    else
+        storeRamInt(registers[7], value);
+}
+
+int64_t Interpreter::stackPop() {
+    int64_t value = wideRegisters ? loadRamNum(ramAddress(registers[7]), 8)
+                                  : loadRamInt(registers[7]);
+    if (fault != Fault::NONE)
+        return 0;
+    registers[7] += wordSize; // Increment RSP
+    return value;
+}
+
+void Interpreter::pushStack(int64_t value) {
+    stackPush(value);
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
 }
 
-int Interpreter::popStack() {
-    int value = readRamInt(sp);
-    registers[7] += sizeof(int); // Increment RSP
-    sp = registers[7];
+int64_t Interpreter::popStack() {
+    int64_t value = stackPop();
+    collectRamFault();
+    if (fault != Fault::NONE)
+        raiseFault();
     return value;
 }
 
+// The heap starts at the first 8 byte boundary at or above base, and so does
+// its break. MALLOC and SBRK raise the break up to the stack, so the heap can
+// use all of this interpreter's RAM.
+void Interpreter::initHeap(size_t base) {
+    size_t max = ramBytes > STACK_SIZE ? ramBytes - STACK_SIZE : 0;
+    base = std::min((base + HEAP_ALIGN - 1) & ~(size_t)(HEAP_ALIGN - 1), max);
+    heap.heap_init(ram.data(), base, base, max, ram.mapped());
+}
+
 std::string Interpreter::readBytecodeString() {
     std::string str = "";
-    while (ip < bytecode_raw.size()) {
+    while (ip < codeSize) {
         char c = static_cast<char>(bytecode_raw[ip++]);
         if (c == '\0') {
             break;
@@ -350,6 +638,454 @@ std::string Interpreter::readBytecodeString() {
     return str;
 }
 
+// Number of operands each opcode reads, -1 for opcodes execute() does not know
+static int operandCountFor(uint8_t opcode) {
+    switch (opcode) {
+        case RET: case LEAVE: case HLT:
+            return 0;
+        case INC: case NOT: case JMP: case JE: case JL: case JNE: case JG:
+        case JLE: case JGE: case CALL: case PUSH: case POP: case ARGC:
+        case ENTER: case IN:
+            return 1;
+        case MOV: case MOVB: case MOVW: case MOVD: case MOVQ: case ADD:
+        case SUB: case MUL: case DIV: case CMP:
+        case AND: case OR: case XOR: case SHL: case SHR: case GETARG:
+        case OUT: case COUT: case OUTCHAR: case MALLOC: case FREE: case LOOP:
+        case JMPTAB: case VSUMB: case VSUMW: case VSUMD: case SBRK:
+            return 2;
+        case MOVADDR: case MOVTO: case OUTSTR: case COPY: case FILL:
+        case CMP_MEM: case CJE: case CJNE: case CJL: case CJG: case CJLE:
+        case CJGE: case VADDB: case VADDW: case VADDD: case VSUBB: case VSUBW:
+        case VSUBD: case VMULB: case VMULW: case VMULD: case VMINB: case VMINW:
+        case VMIND: case VMAXB: case VMAXW: case VMAXD: case VDOTB: case VDOTW:
+        case VDOTD:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+// Which operand of a jump holds its target, -1 for anything else
+static int targetOperand(uint8_t op) {
+    switch (op) {
+        case JMP: case JE: case JL: case JNE: case JG: case JLE: case JGE:
+        case CALL:
+            return 0;
+        case LOOP:
+            return 1;
+        case CJE: case CJNE: case CJL: case CJG: case CJLE: case CJGE:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+void Interpreter::decodeProgram() {
+    auto image = std::make_shared<LoadedProgram>();
+    std::vector<DecodedInstruction> &program = image->program;
+    std::vector<int> &offsetToIndex = image->offsetToIndex;
+    std::vector<DecodedMni> &mniCalls = image->mniCalls;
+    decodeError.clear();
+    offsetToIndex.assign(codeSize + 1, -1);
+
+    int entry = ip;
+    ip = 0;
+    while (ip < codeSize) {
+        DecodedInstruction in;
+        in.offset = ip;
+        in.opcode = bytecode_raw[ip++];
+        in.op = in.opcode;
+        offsetToIndex[in.offset] = program.size();
+
+        int count = operandCountFor(in.opcode);
+        try {
+            if (in.opcode == MNI) {
+                DecodedMni call;
+                call.name = readBytecodeString();
+                while (true) {
+                    BytecodeOperand arg = nextRawOperand();
+                    if (arg.type == OperandType::NONE)
+                        break;
+                    call.args.push_back(arg);
+                }
+                in.target = mniCalls.size();
+                mniCalls.push_back(call);
+            } else {
+                for (int i = 0; i < count; i++) {
+                    in.operands[i] = nextRawOperand();
+                    in.operandCount++;
+                }
+            }
+        } catch (const std::exception &e) {
+            // Report it when (and if) the instruction is actually executed,
+            // which is when the old byte-by-byte decoder would have noticed.
+            decodeError = e.what();
+            in.op = OP_DECODE_FAULT;
+            count = -1;
+        }
+        in.next = ip;
+        program.push_back(in);
+        // Without a known operand count we cannot find the next boundary
+        if (count < 0 && in.opcode != MNI)
+            break;
+    }
+    offsetToIndex[codeSize] = program.size();
+
+    // Bind every MNI call to its function now so executing one needs no
+    // lookup. Registry entries are never removed, so the pointers stay valid.
+    for (const auto &in : program) {
+        if (in.opcode != MNI || in.op == OP_DECODE_FAULT)
+            continue;
+        DecodedMni &call = mniCalls[in.target];
+        auto function = mniRegistry.find(call.name);
+        if (function == mniRegistry.end()) {
+            std::stringstream ss;
+            ss << "Unregistered MNI function: " << call.name
+               << " (at bytecode offset 0x" << std::hex << in.offset << ")";
+            throw std::runtime_error(ss.str());
+        }
+        call.function = &function->second;
+    }
+
+    // Jumping out of the code ends the program
+    auto resolve = [&](long long offset) -> int {
+        if (offset < 0 || offset >= (long long)codeSize)
+            return program.size();
+        return offsetToIndex[offset];
+    };
+    for (auto &in : program) {
+        if (in.op == JMPTAB) {
+            in.target = decodeJumpTable(*image, in.operands[1]);
+            if (in.target >= 0) {
+                DecodedJumpTable &table = image->jumpTables[in.target];
+                for (int offset : table.offsets)
+                    table.targets.push_back(resolve(offset));
+            }
+            continue;
+        }
+        int index = targetOperand(in.op);
+        if (index < 0)
+            continue;
+        const BytecodeOperand &op = in.operands[index];
+        // JMP reg and CALL reg are resolved when they execute
+        if (op.type == OperandType::LABEL_ADDRESS || op.type == OperandType::IMMEDIATE)
+            in.target = resolve(op.value);
+    }
+    fuseSuperinstructions(*image);
+    loaded = std::move(image);
+    verifyError = verifyProgram();
+    verified = verifyError.empty();
+    fastHandlers = loaded->fast;
+    jitBlocks.clear();
+    jitEntries = 0;
+    hotCounts.clear();
+    tierUps.clear();
+    executeSeconds = nativeSeconds = compileSeconds = 0;
+    suspended = false;
+    ip = entry;
+}
+
+
+// Check once at load what the execute loop would otherwise check on every
+// instruction: everything decodes, register operands name one of the 24
+// registers, code addresses are instruction boundaries and data addresses lie
+// in RAM. Returns an empty string for a valid program, else the first problem.
+std::string Interpreter::verifyProgram() const {
+    const std::vector<DecodedInstruction> &program = loaded->program;
+    auto isBoundary = [&](long long offset) {
+        return offset >= 0 && offset <= (long long)codeSize &&
+               loaded->offsetToIndex[offset] >= 0;
+    };
+    auto checkOperand = [&](const BytecodeOperand &op) -> std::string {
+        switch (op.type) {
+            case OperandType::REGISTER:
+            case OperandType::REGISTER_AS_ADDRESS:
+                if (op.value < 0 || op.value >= 24)
+                    return "Invalid register index " + std::to_string(op.value);
+                break;
+            case OperandType::MATH_OPERATOR: {
+                int base = op.value & 0xFF;
+                int math = op.value >> 8 & 0xFF;
+                long long other = op.value >> 16;
+                if (base >= 24 || (op.use_reg && (other < 0 || other >= 24)))
+                    return "Invalid register in memory operand";
+                if (math >= op_NONE)
+                    return "Invalid memory operand operator " + std::to_string(math);
+                break;
+            }
+            case OperandType::LABEL_ADDRESS:
+                if (!isBoundary(op.value))
+                    return "Label address is not an instruction boundary: " +
+                           std::to_string(op.value);
+                break;
+            case OperandType::DATA_ADDRESS:
+                if (op.value < 0 || op.value >= (long long)ramBytes)
+                    return "Data address out of RAM bounds: " + std::to_string(op.value);
+                break;
+            default:
+                break;
+        }
+        return "";
+    };
+
+    for (const auto &in : program) {
+        std::string error;
+        if (in.op == OP_DECODE_FAULT) {
+            error = decodeError;
+        } else if (in.opcode == MNI) {
+            for (const auto &arg : loaded->mniCalls[in.target].args) {
+                error = checkOperand(arg);
+                if (!error.empty())
+                    break;
+            }
+        } else if (operandCountFor(in.opcode) < 0) {
+            error = "Unknown opcode " + std::to_string(in.opcode);
+        } else {
+            for (int i = 0; i < in.operandCount && error.empty(); i++)
+                error = checkOperand(in.operands[i]);
+            if (error.empty() && in.opcode == JMPTAB) {
+                if (in.target < 0) {
+                    error = "JMPTAB requires the data address of a jump table in RAM";
+                } else {
+                    const DecodedJumpTable &table = loaded->jumpTables[in.target];
+                    for (int offset : table.offsets) {
+                        if (!isBoundary(offset)) {
+                            error = "Jump table entry is not an instruction boundary: " +
+                                    std::to_string(offset);
+                            break;
+                        }
+                    }
+                }
+            }
+            bool indirect = (in.opcode == JMP || in.opcode == CALL) &&
+                            in.operands[0].type == OperandType::REGISTER;
+            if (error.empty() && targetOperand(in.opcode) >= 0 && !indirect) {
+                const BytecodeOperand &target = in.operands[targetOperand(in.opcode)];
+                if (target.type != OperandType::LABEL_ADDRESS &&
+                    target.type != OperandType::IMMEDIATE)
+                    error = "Jump requires immediate/label address operand";
+                else if (!isBoundary(target.value))
+                    error = "Jump target is not an instruction boundary: " +
+                            std::to_string(target.value);
+            }
+        }
+        if (!error.empty()) {
+            std::stringstream ss;
+            ss << error << " (at bytecode offset 0x" << std::hex << in.offset << ")";
+            return ss.str();
+        }
+    }
+    if (!program.empty() && program.back().next != (int)codeSize)
+        return "Code segment does not end on an instruction boundary";
+    return "";
+}
+
+// Read the table a JMPTAB operand points at into jumpTables, returns its slot
+// or -1 when the operand is not a data address or the table does not fit in
+// RAM. Instructions that share a table share the slot.
+int Interpreter::decodeJumpTable(LoadedProgram &image, const BytecodeOperand &op) {
+    std::vector<DecodedJumpTable> &jumpTables = image.jumpTables;
+    if (op.type != OperandType::DATA_ADDRESS || op.value < 0 ||
+        op.value + 4 > (long long)ramBytes)
+        return -1;
+    for (size_t slot = 0; slot < jumpTables.size(); slot++)
+        if (jumpTables[slot].address == op.value)
+            return slot;
+    int32_t count;
+    std::memcpy(&count, &ram[op.value], 4);
+    if (count < 0 || op.value + 4 + 4 * (long long)count > (long long)ramBytes)
+        return -1;
+    DecodedJumpTable table;
+    table.address = op.value;
+    table.offsets.resize(count);
+    if (count > 0)
+        std::memcpy(table.offsets.data(), &ram[op.value + 4], 4 * (size_t)count);
+    jumpTables.push_back(std::move(table));
+    return jumpTables.size() - 1;
+}
+
+static bool isRegister(const BytecodeOperand &op, int index = -1) {
+    if (op.type != OperandType::REGISTER || op.value < 0 || op.value >= 24)
+        return false;
+    return index < 0 || op.value == index;
+}
+
+static bool isRegisterOrImmediate(const BytecodeOperand &op) {
+    return isRegister(op) || op.type == OperandType::IMMEDIATE;
+}
+
+// A conditional jump the fused handlers can take without any of the checks
+// the generic handler makes.
+static bool isResolvedBranch(const DecodedInstruction &in) {
+    switch (in.op) {
+        case JE: case JNE: case JL: case JG: case JLE: case JGE:
+            break;
+        default:
+            return false;
+    }
+    return in.target >= 0 &&
+           (in.operands[0].type == OperandType::LABEL_ADDRESS ||
+            in.operands[0].type == OperandType::IMMEDIATE);
+}
+
+// The operand-kind specialized handler for an instruction, or its regular
+// handler when the operands are not a register and a register/immediate.
+static uint8_t specializedHandler(const DecodedInstruction &in) {
+    int index = targetOperand(in.op);
+    if ((in.op == LOOP || index == 2) && in.target >= 0 &&
+        (in.operands[index].type == OperandType::LABEL_ADDRESS ||
+         in.operands[index].type == OperandType::IMMEDIATE) &&
+        isRegister(in.operands[0])) {
+        if (in.op == LOOP)
+            return OP_LOOP_REG;
+        if (isRegister(in.operands[1]))
+            return OP_CJCC_REG_REG;
+        if (in.operands[1].type == OperandType::IMMEDIATE)
+            return OP_CJCC_REG_IMM;
+        return in.op;
+    }
+    if (in.operandCount != 2 || !isRegister(in.operands[0]))
+        return in.op;
+    bool srcIsRegister = isRegister(in.operands[1]);
+    if (!srcIsRegister && in.operands[1].type != OperandType::IMMEDIATE)
+        return in.op;
+    switch (in.op) {
+#define SPECIALIZE(name)                                                       \
+        case name:                                                             \
+            return srcIsRegister ? OP_##name##_REG_REG : OP_##name##_REG_IMM;
+        MASM_FOR_EACH_SPECIALIZED_OPCODE(SPECIALIZE)
+#undef SPECIALIZE
+        default:
+            return in.op;
+    }
+}
+
+void Interpreter::fuseSuperinstructions(LoadedProgram &image) {
+    const std::vector<DecodedInstruction> &program = image.program;
+    for (auto &hits : fusionHits)
+        hits = 0;
+    image.fast.resize(program.size());
+    for (size_t i = 0; i < program.size(); i++) {
+        const DecodedInstruction &in = program[i];
+        const DecodedInstruction *next = i + 1 < program.size() ? &program[i + 1] : nullptr;
+        const DecodedInstruction *after = i + 2 < program.size() ? &program[i + 2] : nullptr;
+        uint8_t &fast = image.fast[i];
+        fast = specializedHandler(in);
+
+        switch (in.op) {
+            case MOV:
+                if (isRegister(in.operands[0], 7) && isRegister(in.operands[1], 6) &&
+                    next && next->op == POP && isRegister(next->operands[0], 6) &&
+                    after && after->op == RET)
+                    fast = OP_POP_FRAME_RET;
+                break;
+            case CMP:
+                if (next && isResolvedBranch(*next))
+                    fast = OP_CMP_JCC;
+                break;
+            case INC:
+                if (isRegister(in.operands[0]) && next && next->op == CMP &&
+                    isRegisterOrImmediate(next->operands[0]) &&
+                    isRegisterOrImmediate(next->operands[1]) &&
+                    after && isResolvedBranch(*after))
+                    fast = OP_INC_CMP_JCC;
+                break;
+            case PUSH:
+                if (isRegister(in.operands[0], 6) && next && next->op == MOV &&
+                    isRegister(next->operands[0], 6) && isRegister(next->operands[1], 7))
+                    fast = OP_PUSH_FRAME;
+                break;
+            case LEAVE:
+                if (next && next->op == RET)
+                    fast = OP_LEAVE_RET;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static const char *fusedName(int op) {
+    switch (op) {
+        case OP_CMP_JCC: return "CMP + Jcc";
+        case OP_INC_CMP_JCC: return "INC + CMP + Jcc";
+        case OP_PUSH_FRAME: return "PUSH RBP + MOV RBP RSP";
+        case OP_LEAVE_RET: return "LEAVE + RET";
+        case OP_POP_FRAME_RET: return "MOV RSP RBP + POP RBP + RET";
+        default: return "???";
+    }
+}
+
+// Put a hot counter on every CALL target and backward-jump target. Loop
+// heads and function bodies are where the time goes; everything else stays
+// in the interpreter.
+void Interpreter::prepareTiering() {
+    const std::vector<DecodedInstruction> &program = loaded->program;
+    jitBlocks.assign(program.size(), nullptr);
+    hotCounts.assign(program.size(), 0);
+    for (size_t i = 0; i < program.size(); i++) {
+        int target = program[i].target;
+        if (target < 0 || target >= (int)program.size() || targetOperand(program[i].op) < 0)
+            continue;
+        if (program[i].op != CALL && (size_t)target > i)
+            continue;
+        fastHandlers[target] = OP_HOT_COUNTER;
+    }
+}
+
+// Compile the block at a hot target and return the handler it runs with
+// from now on: the native block, or its old handler if it cannot be
+// compiled.
+uint8_t Interpreter::promoteBlock(size_t index) {
+    auto start = std::chrono::steady_clock::now();
+    jitBlocks[index] = jit.compile(loaded->program, index, wideRegisters);
+    compileSeconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    if (jitBlocks[index]) {
+        fastHandlers[index] = OP_JIT_BLOCK;
+        tierUps.push_back(loaded->program[index].offset);
+    } else {
+        fastHandlers[index] = loaded->fast[index];
+    }
+    return fastHandlers[index];
+}
+
+void Interpreter::printTiering(std::ostream &out) const {
+    out << "Tier-ups: " << tierUps.size() << " block(s) compiled after "
+        << JIT_HOT_THRESHOLD << " executions, entered " << jitEntries
+        << " times\n";
+    for (int offset : tierUps)
+        out << "  block at 0x" << std::hex << offset << std::dec << "\n";
+    double interpreted = executeSeconds - nativeSeconds - compileSeconds;
+    out << std::fixed << std::setprecision(3) << "Time: interpreter "
+        << interpreted * 1000 << " ms, native " << nativeSeconds * 1000
+        << " ms, compiling " << compileSeconds * 1000 << " ms\n";
+    out.unsetf(std::ios::floatfield);
+}
+
+void Interpreter::printStats(std::ostream &out) const {
+    out << "Instructions executed: " << instructionsExecuted << "\n";
+    out << "Vector kernels: " << vectorIsaName(vectorIsa()) << "\n";
+    if (jitEnabled)
+        printTiering(out);
+    out << "Superinstructions:\n";
+    for (int i = 0; i < OP_FUSED_COUNT; i++) {
+        out << "  " << std::left << std::setw(30) << fusedName(OP_FUSED_FIRST + i)
+            << std::right << fusionHits[i] << "\n";
+    }
+}
+
+size_t Interpreter::instructionIndex(int offset) {
+    if (offset < 0 || offset >= (int)codeSize)
+        return loaded->program.size();
+    int index = loaded->offsetToIndex[offset];
+    if (index < 0) {
+        setFault(Fault::BAD_JUMP_TARGET, offset);
+        return loaded->program.size();
+    }
+    return index;
+}
+
 void Interpreter::initializeMNIFunctions() {
     // Example: Math.sin R1 R2 (R1=input reg, R2=output reg)
     registerMNI(
@@ -484,11 +1220,18 @@ void Interpreter::load(const std::string &bytecodeFile) {
     if (header.version > VERSION) {
         throw std::runtime_error(
             "Unsupported bytecode version: " + std::to_string(header.version) +
-            " (Supported version: 2)");
+            " (Supported version: " + std::to_string(VERSION) + ")");
     }
-
-    // 3. Load Code Segment into bytecode_raw
-    bytecode_raw.resize(header.codeSize);
+    // Version 3 binaries may ask for 64-bit registers, everything older has
+    // 32-bit ones
+    wideRegisters = header.version >= 3 && (header.flags & BINARY_FLAG_WIDE_REGISTERS);
+    wordSize = wideRegisters ? 8 : 4;
+    shiftMask = wideRegisters ? 63 : 31;
+
+    // 3. Load Code Segment into bytecode_raw, zero padded so operands can be
+    // read with whole-word loads
+    codeSize = header.codeSize;
+    bytecode_raw.assign(codeSize + BYTECODE_PADDING, 0);
     if (header.codeSize > 0) {
         if (!in.read(reinterpret_cast<char *>(bytecode_raw.data()),
                      header.codeSize)) {
@@ -498,27 +1241,51 @@ void Interpreter::load(const std::string &bytecodeFile) {
         }
     }
 
-    // 4. Load Data Segment into RAM at dataSegmentBase
+    // 4. Load the data records into RAM: an address and a size, then the
+    // bytes. Both are 16-bit unless the binary has BINARY_FLAG_WIDE_DATA.
+    ram.touch();
+    size_t dataEnd = 0;
     if (header.dataSize > 0) {
-        if (header.dataSize > ram.size()) {
-            throw std::runtime_error("RAM size (" + std::to_string(ram.size()) +
-                                     ") too small for data segment (size " +
-                                     std::to_string(header.dataSize) + ")");
+        std::vector<char> data(header.dataSize);
+        if (!in.read(data.data(), header.dataSize)) {
+            throw std::runtime_error("Failed to read data segment (expected " +
+                                     std::to_string(header.dataSize) +
+                                     " bytes)");
         }
-        char *data = (char *)malloc(header.dataSize * sizeof(char));
-        char *tmp_data = data;
-        in.read(data, header.dataSize);
-        while (data < tmp_data + header.dataSize) {
-            int16_t addr = *(int16_t *)&data[0];
-            int16_t size = *(int16_t *)&data[2];
-            data += 4;
-            for (int i = 0; i < size; i++) {
-                ram[addr + i] = data[i];
-            }
-            data += size;
+        size_t field = header.version >= 3 &&
+                               (header.flags & BINARY_FLAG_WIDE_DATA)
+                           ? 4
+                           : 2;
+        size_t pos = 0;
+        while (pos < data.size()) {
+            if (data.size() - pos < 2 * field) {
+                throw std::runtime_error(
+                    "Truncated data record at data segment offset " +
+                    std::to_string(pos));
+            }
+            uint32_t addr = 0, size = 0;
+            memcpy(&addr, &data[pos], field);
+            memcpy(&size, &data[pos + field], field);
+            pos += 2 * field;
+            if (size > data.size() - pos) {
+                throw std::runtime_error(
+                    "Data record at address " + std::to_string(addr) +
+                    " runs past the end of the data segment");
+            }
+            if ((size_t)addr + size > ramBytes) {
+                throw std::runtime_error(
+                    "RAM size (" + std::to_string(ramBytes) +
+                    ") too small for data record at address " +
+                    std::to_string(addr) + " (size " + std::to_string(size) +
+                    ")");
+            }
+            std::copy(data.begin() + pos, data.begin() + pos + size,
+                      ram.begin() + addr);
+            dataEnd = std::max(dataEnd, (size_t)addr + size);
+            pos += size;
         }
-        free((char *)tmp_data);
     }
+    initHeap(dataEnd);
 
     if (header.dbgSize > 0) {
         char *dbg = (char *)malloc(header.dbgSize);
@@ -555,6 +1322,11 @@ void Interpreter::load(const std::string &bytecodeFile) {
     }
     ip = header.entryPoint;
 
+    // 6. Decode the code segment once so execute() can run over it directly
+    decodeProgram();
+    bytecode_raw.clear();
+    bytecode_raw.shrink_to_fit();
+
     if (debugMode) {
         std::cout << "[Debug][Interpreter] Loading bytecode from: "
                   << bytecodeFile << "\n";
@@ -566,6 +1338,13 @@ void Interpreter::load(const std::string &bytecodeFile) {
         std::cout << "[Debug][Interpreter]   Data Segment loaded" << "\n";
         std::cout << "[Debug][Interpreter]   IP set to entry point: 0x"
                   << std::hex << ip << std::dec << "\n";
+        std::cout << "[Debug][Interpreter]   Decoded " << loaded->program.size()
+                  << " instructions\n";
+        if (verified)
+            std::cout << "[Debug][Interpreter]   Verified\n";
+        else
+            std::cout << "[Debug][Interpreter]   Not verified, running with "
+                         "checks: " << verifyError << "\n";
     }
 }
 
@@ -577,6 +1356,10 @@ void Interpreter::setArguments(const std::vector<std::string> &args) {
     }
 }
 
+void Interpreter::setJitEnabled(bool enabled) {
+    jitEnabled = enabled;
+}
+
 void Interpreter::setDebugMode(bool enabled) {
     debugMode = enabled;
     if (debugMode) {
@@ -729,555 +1512,1032 @@ void Interpreter::debugger(bool end) {
     }
 }
 
-void Interpreter::execute() {
-    // Reset flags before execution? Or assume they persist? Assume reset for
-    // now.
-    zeroFlag = false;
-    signFlag = false;
-    // IP should be set by load() or jump instructions
+static const char *opcodeName(Opcode opcode) {
+    static const char *vectorNames[] = {
+        "VADDB", "VADDW", "VADDD", "VSUBB", "VSUBW", "VSUBD", "VMULB",
+        "VMULW", "VMULD", "VMINB", "VMINW", "VMIND", "VMAXB", "VMAXW",
+        "VMAXD", "VSUMB", "VSUMW", "VSUMD", "VDOTB", "VDOTW", "VDOTD"};
+    if (opcode >= VADDB && opcode <= VDOTD)
+        return vectorNames[opcode - VADDB];
+    switch (opcode) { // Basic opcode names for debug
+    case MOV:
+        return "MOV";
+    case MOVB:
+        return "MOVB";
+    case MOVW:
+        return "MOVW";
+    case MOVD:
+        return "MOVD";
+    case MOVQ:
+        return "MOVQ";
+    case LOOP:
+        return "LOOP";
+    case CJE:
+        return "CJE";
+    case CJNE:
+        return "CJNE";
+    case CJL:
+        return "CJL";
+    case CJG:
+        return "CJG";
+    case CJLE:
+        return "CJLE";
+    case CJGE:
+        return "CJGE";
+    case JMPTAB:
+        return "JMPTAB";
+    case ADD:
+        return "ADD";
+    case SUB:
+        return "SUB";
+    case MUL:
+        return "MUL";
+    case DIV:
+        return "DIV";
+    case INC:
+        return "INC";
+    case JMP:
+        return "JMP";
+    case CMP:
+        return "CMP";
+    case JE:
+        return "JE";
+    case JL:
+        return "JL";
+    case CALL:
+        return "CALL";
+    case RET:
+        return "RET";
+    case PUSH:
+        return "PUSH";
+    case POP:
+        return "POP";
+    case OUT:
+        return "OUT";
+    case COUT:
+        return "COUT";
+    case OUTSTR:
+        return "OUTSTR";
+    case OUTCHAR:
+        return "OUTCHAR";
+    case HLT:
+        return "HLT";
+    case ARGC:
+        return "ARGC";
+    case GETARG:
+        return "GETARG";
+    case DB:
+        return "DB";
+    case LBL:
+        return "LBL";
+    case AND:
+        return "AND";
+    case OR:
+        return "OR";
+    case XOR:
+        return "XOR";
+    case NOT:
+        return "NOT";
+    case SHL:
+        return "SHL";
+    case SHR:
+        return "SHR";
+    case MOVADDR:
+        return "MOVADDR";
+    case MOVTO:
+        return "MOVTO";
+    case JNE:
+        return "JNE";
+    case JG:
+        return "JG";
+    case JLE:
+        return "JLE";
+    case JGE:
+        return "JGE";
+    case ENTER:
+        return "ENTER";
+    case LEAVE:
+        return "LEAVE";
+    case COPY:
+        return "COPY";
+    case FILL:
+        return "FILL";
+    case CMP_MEM:
+        return "CMP_MEM";
+    case MNI:
+        return "MNI";
+    case IN:
+        return "IN";
+    case MALLOC:
+        return "MALLOC";
+    case FREE:
+        return "FREE";
+    case SBRK:
+        return "SBRK";
+    default:
+        return "???";
+    }
+}
 
-    // Ensure SP and BP reflect register values at start
-    sp = registers[7];
-    bp = registers[6];
+// Whether a conditional jump is taken for the given flags
+static inline bool conditionMet(Opcode opcode, bool zeroFlag, bool signFlag) {
+    switch (opcode) {
+    case JE:
+        return zeroFlag;
+    case JNE:
+        return !zeroFlag;
+    case JL:
+        return signFlag;
+    case JG:
+        return !zeroFlag && !signFlag;
+    case JLE:
+        return zeroFlag || signFlag;
+    case JGE:
+        return zeroFlag || !signFlag;
+    default:
+        return false; // Should not happen
+    }
+}
 
-    bool exit = false;
-    if (debugMode) debugger_init();
-    while (ip < bytecode_raw.size() && !exit) {
-        if (debugMode) debugger();
-        int currentIp = ip;
-        if (debugMode)
-            std::cout << "[Debug][Interpreter] IP: " << print_ip(ip);
-
-        Opcode opcode = static_cast<Opcode>(bytecode_raw[ip++]);
-
-        if (debugMode) {
-            std::cout << ": Opcode 0x" << std::hex << std::setw(2)
-                      << std::setfill('0') << static_cast<int>(opcode)
-                      << std::dec;
-            // You might want a helper function to convert Opcode enum to string
-            // here
-            std::cout << " (";
-            switch (opcode) { // Basic opcode names for debug
-            case MOV:
-                std::cout << "MOV";
-                break;
-            case MOVB:
-                std::cout << "MOVB";
-                break;
-            case ADD:
-                std::cout << "ADD";
-                break;
-            case SUB:
-                std::cout << "SUB";
-                break;
-            case MUL:
-                std::cout << "MUL";
-                break;
-            case DIV:
-                std::cout << "DIV";
-                break;
-            case INC:
-                std::cout << "INC";
-                break;
-            case JMP:
-                std::cout << "JMP";
-                break;
-            case CMP:
-                std::cout << "CMP";
-                break;
-            case JE:
-                std::cout << "JE";
-                break;
-            case JL:
-                std::cout << "JL";
-                break;
-            case CALL:
-                std::cout << "CALL";
-                break;
-            case RET:
-                std::cout << "RET";
-                break;
-            case PUSH:
-                std::cout << "PUSH";
-                break;
-            case POP:
-                std::cout << "POP";
-                break;
-            case OUT:
-                std::cout << "OUT";
-                break;
-            case COUT:
-                std::cout << "COUT";
-                break;
-            case OUTSTR:
-                std::cout << "OUTSTR";
-                break;
-            case OUTCHAR:
-                std::cout << "OUTCHAR";
-                break;
-            case HLT:
-                std::cout << "HLT";
-                break;
-            case ARGC:
-                std::cout << "ARGC";
-                break;
-            case GETARG:
-                std::cout << "GETARG";
-                break;
-            case DB:
-                std::cout << "DB";
-                break;
-            case LBL:
-                std::cout << "LBL";
-                break;
-            case AND:
-                std::cout << "AND";
-                break;
-            case OR:
-                std::cout << "OR";
-                break;
-            case XOR:
-                std::cout << "XOR";
-                break;
-            case NOT:
-                std::cout << "NOT";
-                break;
-            case SHL:
-                std::cout << "SHL";
-                break;
-            case SHR:
-                std::cout << "SHR";
-                break;
-            case MOVADDR:
-                std::cout << "MOVADDR";
-                break;
-            case MOVTO:
-                std::cout << "MOVTO";
-                break;
-            case JNE:
-                std::cout << "JNE";
-                break;
-            case JG:
-                std::cout << "JG";
-                break;
-            case JLE:
-                std::cout << "JLE";
-                break;
-            case JGE:
-                std::cout << "JGE";
-                break;
-            case ENTER:
-                std::cout << "ENTER";
-                break;
-            case LEAVE:
-                std::cout << "LEAVE";
-                break;
-            case COPY:
-                std::cout << "COPY";
-                break;
-            case FILL:
-                std::cout << "FILL";
-                break;
-            case CMP_MEM:
-                std::cout << "CMP_MEM";
-                break;
-            case MNI:
-                std::cout << "MNI";
-                break;
-            case IN:
-                std::cout << "IN";
-                break;
-            case MALLOC:
-                std::cout << "MALLOC";
-                break;
-            case FREE:
-                std::cout << "FREE";
-                break;
-            default:
-                std::cout << "???";
-                break;
+// Whether a conditional jump is taken after comparing lhs with rhs, the same
+// answer conditionMet() gives for the flags such a CMP would set.
+static inline bool compareMet(uint8_t opcode, int64_t lhs, int64_t rhs) {
+    switch (opcode) {
+    case JE: case CJE:
+        return lhs == rhs;
+    case JNE: case CJNE:
+        return lhs != rhs;
+    case JL: case CJL:
+        return lhs < rhs;
+    case JG: case CJG:
+        return lhs > rhs;
+    case JLE: case CJLE:
+        return lhs <= rhs;
+    case JGE: case CJGE:
+        return lhs >= rhs;
+    default:
+        return false;
+    }
+}
+
+inline bool Interpreter::conditionHolds(uint8_t opcode) const {
+    if (flagKind == FlagKind::COMPARE)
+        return compareMet(opcode, flagLhs, flagRhs);
+    return conditionMet(static_cast<Opcode>(opcode), flagLhs, flagRhs);
+}
+
+void Interpreter::debugBeforeInstruction(Opcode opcode,
+                                         std::vector<int64_t> &regsBefore) {
+    debugger();
+    std::cout << "[Debug][Interpreter] IP: " << print_ip(ip);
+    std::cout << ": Opcode 0x" << std::hex << std::setw(2) << std::setfill('0')
+              << static_cast<int>(opcode) << std::dec;
+    std::cout << " (" << opcodeName(opcode) << ")\n";
+
+    // Store pre-execution register state for comparison
+    regsBefore.assign(registers.begin(), registers.end());
+}
+
+void Interpreter::debugAfterInstruction(const std::vector<int64_t> &regsBefore) {
+    // Print changed registers
+    for (size_t i = 0; i < registers.size(); ++i) {
+        if (registers[i] != regsBefore[i]) {
+            std::cout << "[Debug][Interpreter]     Reg Change: R" << i << " = "
+                      << registers[i] << " (was " << regsBefore[i] << ")\n";
+        }
+    }
+    // Print flag changes if CMP or relevant instruction executed
+    // (Requires tracking if flags were potentially modified by the opcode)
+}
+
+// Cold path of the execute loop: print the MNI stack, the error, an optional
+// stack trace and the register dump for a fault at currentIp.
+void Interpreter::reportFault(bool trace, int currentIp, Opcode opcode,
+                              const std::string &message) {
+    // Print MNI stack trace if any
+
+    if (!mniCallStack.empty()) {
+        std::cerr << "MNI Call Stack (most recent call last):\n";
+        for (auto it = mniCallStack.rbegin(); it != mniCallStack.rend();
+             ++it) {
+            std::cerr << "  at " << *it << std::endl;
+        }
+    }
+    std::cerr << "\nRuntime Error at bytecode offset 0x" << std::hex
+              << currentIp << std::dec << " (Opcode: 0x" << std::hex
+              << static_cast<int>(opcode) << std::dec
+              << "): " << message << std::endl;
+    // Stack trace if -t or --trace
+    if (trace) {
+        std::cerr << "\nStack Trace (most recent call first):\n";
+        struct stack_frame frame;
+        frame.rbp = registers[6]; // ebp
+        frame.ip = ip;
+
+        while (frame.rbp != 0) {
+            std::cerr << getAddr(frame.ip, lbls) << std::endl;
+            frame.ip = readRamNum(frame.rbp + wordSize, wordSize);
+            frame.rbp = readRamNum(frame.rbp, wordSize);
+        }
+        std::cerr << "\n";
+    }
+    static const char *regNames[24] = {
+
+        "RAX", "RBX", "RCX", "RDX", "RSI",
+        "RDI", "RBP", "RSP",
+
+        "R0",  "R1",  "R2",  "R3",  "R4",
+        "R5",  "R6",  "R7",
+
+        "R8",  "R9",  "R10", "R11", "R12",
+        "R13", "R14", "R15"
+
+    };
+
+    // Dump registers with names and color
+    std::cerr << "Register dump:\n";
+    // Dump registers as an ASCII box (8 per row)
+    const int regsPerRow = 8;
+    const int totalRegs = registers.size();
+    const int rows = (totalRegs + regsPerRow - 1) / regsPerRow;
+    const int colWidth = wideRegisters ? 20 : 12; // Match hex value width
+    std::cerr << "+"
+              << std::string(regsPerRow * (colWidth + 1) - 1, '-')
+              << "+\n";
+    for (int row = 0; row < rows; ++row) {
+        // Header row: register names (centered, colWidth chars)
+        std::cerr << "|";
+        for (int col = 0; col < regsPerRow; ++col) {
+            int idx = row * regsPerRow + col;
+            if (idx < totalRegs) {
+                std::string color;
+                if (idx == 0)
+                    color = "\033[1;33m"; // RAX: yellow
+                else if (idx == 6 || idx == 7)
+                    color = "\033[1;36m"; // RBP/RSP: cyan
+                else
+                    color = "\033[1m";
+                std::string name = regNames[idx];
+                int pad = colWidth - name.length();
+                int left = pad / 2, right = pad - left;
+                std::cerr << color << std::string(left, ' ') << name
+                          << std::string(right, ' ') << "\033[0m"
+                          << "|";
+            } else {
+                std::cerr << std::string(colWidth, ' ') << "|";
+            }
+        }
+        std::cerr << "\n|";
+        // Value row: decimal values (colWidth chars)
+        for (int col = 0; col < regsPerRow; ++col) {
+            int idx = row * regsPerRow + col;
+            if (idx < totalRegs) {
+                std::cerr << std::setw(colWidth - 1) << registers[idx]
+                          << " |";
+            } else {
+                std::cerr << std::string(colWidth, ' ') << "|";
+            }
+        }
+
+        std::cerr << "\n|";
+        // Value row: hex values (colWidth chars)
+        for (int col = 0; col < regsPerRow; ++col) {
+            int idx = row * regsPerRow + col;
+            if (idx < totalRegs) {
+                std::stringstream hexss;
+                if (wideRegisters)
+                    hexss << "0x" << std::hex << std::setw(16) << std::setfill('0')
+                          << (uint64_t)registers[idx] << std::dec;
+                else
+                    hexss << "0x" << std::hex << std::setw(8) << std::setfill('0')
+                          << (uint32_t)registers[idx] << std::dec;
+                std::string hexval = hexss.str();
+                int pad = colWidth - hexval.length();
+                int left = pad / 2, right = pad - left;
+                std::cerr << std::string(left, ' ') << hexval
+                          << std::string(right, ' ') << "|";
+            } else {
+                std::cerr << std::string(colWidth, ' ') << "|";
             }
-            std::cout << ")\n";
         }
 
-        // Store pre-execution register state for comparison if needed
-        std::vector<int> regsBefore;
-        if (debugMode)
-            regsBefore = registers;
+        std::cerr << "\n+"
+                  << std::string(regsPerRow * (colWidth + 1) - 1, '-')
+                  << "+\n";
+    }
+
+    std::cerr << "  ZF=" << getZeroFlag() << ", SF=" << getSignFlag() << "\n";
 
-        try {
-            switch (opcode) {
+    std::cerr << "\n";
+    // std::cerr << "\033[1;33mRAX\033[0m, \033[1;36mRBP/RSP\033[0m:
+    // special "
+    //              "registers\n";
+
+    heap.check_unfreed_memory(true); // cleanup heap
+}
+
+// Every handler label of the execute loop, used to build the direct-threaded
+// dispatch table.
+#define MASM_FOR_EACH_HANDLER(X)                                               \
+    X(MOV) X(MOVB) X(MOVW) X(MOVD) X(MOVQ) X(ADD) X(SUB) X(MUL) X(DIV) X(INC) \
+    X(JMP) X(CMP) X(JE)                                                        \
+    X(JNE) X(JL) X(JG) X(JLE) X(JGE) X(CALL) X(RET) X(PUSH) X(POP) X(OUT)      \
+    X(COUT) X(OUTSTR) X(OUTCHAR) X(IN) X(HLT) X(ARGC) X(GETARG) X(AND) X(OR)   \
+    X(XOR) X(NOT) X(SHL) X(SHR) X(MOVADDR) X(MOVTO) X(ENTER) X(LEAVE) X(COPY)  \
+    X(FILL) X(CMP_MEM) X(MALLOC) X(FREE) X(MNI) X(OP_DECODE_FAULT)           \
+    X(OP_JIT_BLOCK) X(OP_HOT_COUNTER) X(OP_CMP_JCC) X(OP_INC_CMP_JCC)          \
+    X(OP_PUSH_FRAME) X(OP_LEAVE_RET) X(OP_POP_FRAME_RET) X(LOOP) X(CJE)       \
+    X(CJNE) X(CJL) X(CJG) X(CJLE) X(CJGE) X(OP_LOOP_REG) X(OP_CJCC_REG_REG)    \
+    X(OP_CJCC_REG_IMM) X(JMPTAB) X(VADDB) X(VADDW) X(VADDD) X(VSUBB) X(VSUBW) \
+    X(VSUBD) X(VMULB) X(VMULW) X(VMULD) X(VMINB) X(VMINW) X(VMIND) X(VMAXB)   \
+    X(VMAXW) X(VMAXD) X(VSUMB) X(VSUMW) X(VSUMD) X(VDOTB) X(VDOTW) X(VDOTD)   \
+    X(SBRK)
+
+// ADD<REGISTER, IMMEDIATE> and friends: the destination is known to be a
+// valid register and the source a valid register or an immediate, so the
+// operands are read without getValue()/writeToOperand(). Each expression
+// matches the generic handler of the same opcode.
+template <uint8_t Op, OperandType Src>
+inline void Interpreter::executeSpecialized(const DecodedInstruction &in) {
+    int64_t &dest = registers[in.operands[0].value];
+    int64_t src = Src == OperandType::REGISTER ? registers[in.operands[1].value]
+                                               : (int64_t)in.operands[1].value;
+    switch (Op) {
+        case MOV: dest = toRegister(src); break;
+        case ADD: dest = toRegister(wrapAdd(src, dest)); break;
+        case SUB: dest = toRegister(wrapSub(dest, src)); break;
+        case MUL: dest = toRegister(wrapMul(src, dest)); break;
+        case AND: dest = toRegister(dest & src); break;
+        case OR: dest = toRegister(dest | src); break;
+        case XOR: dest = toRegister(dest ^ src); break;
+        case SHL: dest = toRegister((int64_t)((uint64_t)dest << (src & shiftMask))); break;
+        case SHR: dest = toRegister(dest >> (src & shiftMask)); break;
+        case CMP:
+            setCompare(dest, src);
+            break;
+    }
+}
+
+template <bool Debug, bool Trace, bool Checked>
+ExecutionStatus Interpreter::run(uint64_t budget) {
+    // A run that was suspended continues with its flags and instruction count
+    bool resuming = suspended;
+    suspended = false;
+    // Reset flags before execution? Or assume they persist? Assume reset for
+    // now.
+    if (!resuming)
+        setFlags(false, false);
+    // IP should be set by load() or jump instructions
+
+    bool exit = false;
+    fault = Fault::NONE;
+    trapCode = Fault::NONE;
+    trapIp = -1;
+    ramOutOfBounds = 0;
+    size_t pc = instructionIndex(ip);
+    if (fault != Fault::NONE)
+        raiseFault();
+    uint64_t executed = 0; // In this call
+    uint64_t executedBefore = resuming ? instructionsExecuted : 0;
+    // The decoded program does not change while it runs
+    const LoadedProgram &image = *loaded;
+    const DecodedInstruction *program = image.program.data();
+    const size_t programSize = image.program.size();
+    const uint8_t *fast = fastHandlers.data();
+    const DecodedInstruction *in = nullptr;
+    int currentIp = ip;
+    Opcode opcode = static_cast<Opcode>(0);
+    std::vector<int64_t> regsBefore; // Only used by the Debug instantiation
+    if (Debug && !resuming) debugger_init();
+
+    // Fetch the next decoded instruction, leaving the loop after HLT or when
+    // execution runs off the end of the program.
+#define FETCH()                                                                \
+    if (pc >= programSize || exit)                                             \
+        goto done;                                                             \
+    in = &program[pc++];                                                       \
+    executed++;                                                                \
+    ip = in->offset;                                                           \
+    currentIp = ip;                                                            \
+    opcode = static_cast<Opcode>(in->opcode);                                  \
+    if (Debug)                                                                 \
+        debugBeforeInstruction(opcode, regsBefore);                            \
+    ip = in->next;
+
+    // Move on to the next instruction of a superinstruction's sequence so
+    // faults inside it are reported at the right offset.
+#define STEP()                                                                 \
+    in = &program[pc++];                                                       \
+    executed++;                                                                \
+    currentIp = in->offset;                                                    \
+    opcode = static_cast<Opcode>(in->opcode);                                  \
+    ip = in->next;
+
+    // The debugger steps through single instructions, so only the release
+    // loop uses superinstructions.
+#define HANDLER_OF(in) (Debug ? (in)->op : fast[(in) - program])
+
+#if MASM_USE_THREADED_DISPATCH
+    // Direct threading: every handler ends in its own indirect jump to the
+    // next handler, giving the branch predictor one site per opcode.
+    void *handlers[256];
+    for (auto &handler : handlers)
+        handler = &&op_default;
+#define HANDLER(name) handlers[name] = &&op_##name;
+    MASM_FOR_EACH_HANDLER(HANDLER)
+#define SPECIALIZED_HANDLER(name)                                              \
+    HANDLER(OP_##name##_REG_REG) HANDLER(OP_##name##_REG_IMM)
+    MASM_FOR_EACH_SPECIALIZED_OPCODE(SPECIALIZED_HANDLER)
+#undef SPECIALIZED_HANDLER
+#undef HANDLER
+#define OP(name) op_##name:
+#define OP_DEFAULT op_default:
+#define NEXT()                                                                 \
+    do {                                                                       \
+        if (Debug)                                                             \
+            debugAfterInstruction(regsBefore);                                 \
+        FETCH();                                                               \
+        goto *handlers[HANDLER_OF(in)];                                        \
+    } while (0)
+#define DISPATCH() goto *handlers[HANDLER_OF(in)];
+#define REDISPATCH(handler) goto *handlers[handler]
+#define END_DISPATCH()
+#else
+    // Portable fallback: one shared switch.
+#define OP(name) case name:
+#define OP_DEFAULT default:
+#define NEXT() break
+    uint8_t handler = 0;
+#define DISPATCH()                                                             \
+    handler = HANDLER_OF(in);                                                  \
+    dispatch:                                                                  \
+    switch (handler) {
+#define REDISPATCH(next)                                                       \
+    do {                                                                       \
+        handler = (next);                                                      \
+        goto dispatch;                                                         \
+    } while (0)
+#define END_DISPATCH()                                                         \
+    }                                                                          \
+    if (Debug)                                                                 \
+        debugAfterInstruction(regsBefore);
+#endif
+
+    // Faults leave the loop through the trap: label below instead of
+    // throwing, so no handler runs inside a try block.
+#define CHECK()                                                                \
+    if (fault != Fault::NONE)                                                  \
+    goto trap
+#define TRAP(code)                                                             \
+    do {                                                                       \
+        setFault(code);                                                        \
+        goto trap;                                                             \
+    } while (0)
+#define TRAP_MESSAGE(text)                                                     \
+    do {                                                                       \
+        faultText = (text);                                                    \
+        setFault(Fault::MESSAGE);                                              \
+        goto trap;                                                             \
+    } while (0)
+    // Charge the budget where control leaves a basic block. `executed` is
+    // counted per instruction anyway, so this is one compare per block.
+#define METER()                                                                \
+    if (executed >= budget)                                                    \
+    goto suspend
+    // Masked RAM records out-of-range accesses in ramOutOfBounds; they are
+    // only reported where control leaves a basic block and at the end.
+#define CHECK_RAM()                                                            \
+    do {                                                                       \
+        if (MASM_USE_MASKED_RAM && ramOutOfBounds) {                           \
+            collectRamFault();                                                 \
+            goto trap;                                                         \
+        }                                                                      \
+    } while (0)
+
+    {
+        for (;;) {
+            FETCH();
+            DISPATCH();
             // Basic Arithmetic
-            case MOV: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(MOV) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_src, 4), 4);
-                break;
+                int64_t value = loadValue<Checked>(op_src, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, value, wordSize);
+                CHECK();
+                NEXT();
             }
-            case MOVB: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(MOVB)
+            OP(MOVW)
+            OP(MOVD)
+            OP(MOVQ) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_src, 1), 1);
-                break;
+                int width = moveWidth(opcode);
+                int64_t value = loadValue<Checked>(op_src, width);
+                CHECK();
+                writeToOperand<Checked>(op_dest, value, width);
+                CHECK();
+                NEXT();
             }
-            case ADD: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(ADD) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_src, 4) + getValue(op_dest, 4), 4);
-                break;
+                int64_t src = loadValue<Checked>(op_src, wordSize);
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, wrapAdd(src, dest), wordSize);
+                CHECK();
+                NEXT();
             }
-            case SUB: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(SUB) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_dest, 4) - getValue(op_src, 4), 4);
-                break;
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                int64_t src = loadValue<Checked>(op_src, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, wrapSub(dest, src), wordSize);
+                CHECK();
+                NEXT();
             }
-            case MUL: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(MUL) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_src, 4) * getValue(op_dest, 4), 4);
-                break;
+                int64_t src = loadValue<Checked>(op_src, wordSize);
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, wrapMul(src, dest), wordSize);
+                CHECK();
+                NEXT();
             }
-            case DIV: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(DIV) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                int src_val = getValue(op_src, 4);
+                int64_t src_val = loadValue<Checked>(op_src, wordSize);
+                CHECK();
                 if (src_val == 0)
-                    throw std::runtime_error("Division by zero");
-                writeToOperand(op_dest, getValue(op_dest, 4) / src_val, 4);
-                break;
+                    TRAP(Fault::DIVISION_BY_ZERO);
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                CHECK();
+                // INT64_MIN / -1 would trap on the host, it wraps instead
+                int64_t quotient = src_val == -1 ? wrapSub(0, dest)
+                                                 : dest / src_val;
+                writeToOperand<Checked>(op_dest, quotient, wordSize);
+                CHECK();
+                NEXT();
             }
-            case INC: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(INC) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                writeToOperand(op_dest, getValue(op_dest, 4)+1, 4);
-                break;
+                int64_t value = loadValue<Checked>(op_dest, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, wrapAdd(value, 1), wordSize);
+                CHECK();
+                NEXT();
             }
 
             // Flow Control
-            case JMP: {
-                BytecodeOperand op_target = nextRawOperand();
-                if (debugMode)
+            OP(JMP) {
+                const BytecodeOperand &op_target = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Target): "
                               << formatOperandDebug(op_target) << "\n";
-                // Target should be immediate label address from compiler
-                if (op_target.type != OperandType::LABEL_ADDRESS &&
-                    op_target.type != OperandType::IMMEDIATE) {
-                    throw std::runtime_error(
-                        "JMP requires immediate/label address operand");
+                if (op_target.type == OperandType::REGISTER) {
+                    // Indirect jump to the code offset in the register
+                    int64_t target = loadValue<Checked>(op_target, wordSize);
+                    CHECK();
+                    CHECK_RAM();
+                    ip = ramAddress(target);
+                    pc = instructionIndex(ip);
+                    CHECK();
+                } else {
+                    // Target should be immediate label address from compiler
+                    if (Checked && op_target.type != OperandType::LABEL_ADDRESS &&
+                        op_target.type != OperandType::IMMEDIATE) {
+                        TRAP_MESSAGE("JMP requires immediate/label address operand");
+                    }
+                    CHECK_RAM();
+                    ip = op_target.value; // Jump to absolute address
+                    pc = !Checked || in->target >= 0 ? in->target : instructionIndex(ip);
+                    CHECK();
                 }
-                ip = op_target.value; // Jump to absolute address
-                if (debugMode)
+                if (Debug)
                     std::cout << "[Debug][Interpreter]     Jumping to 0x"
                               << std::hex << ip << std::dec << "\n";
-                break;
+                METER();
+                NEXT();
             }
-            case CMP: {
-                BytecodeOperand op1 = nextRawOperand();
-                if (debugMode)
+            OP(CMP) {
+                const BytecodeOperand &op1 = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1: "
                               << formatOperandDebug(op1) << "\n";
-                BytecodeOperand op2 = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op2 = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2: "
                               << formatOperandDebug(op2) << "\n";
-                int val1 = getValue(op1, 4);
-                int val2 = getValue(op2, 4);
-                zeroFlag = (val1 == val2);
-                signFlag = (val1 < val2);
-                if (debugMode)
+                int64_t val1 = loadValue<Checked>(op1, wordSize);
+                int64_t val2 = loadValue<Checked>(op2, wordSize);
+                CHECK();
+                setCompare(val1, val2);
+                if (Debug)
                     std::cout << "[Debug][Interpreter]     Compare(" << val1
-                              << ", " << val2 << ") -> ZF=" << zeroFlag
-                              << ", SF=" << signFlag << "\n";
-                break;
+                              << ", " << val2 << ") -> ZF=" << getZeroFlag()
+                              << ", SF=" << getSignFlag() << "\n";
+                NEXT();
             }
             // Conditional Jumps (JE, JNE, JL, JG, JLE, JGE)
-            case JE:
-            case JNE:
-            case JL:
-            case JG:
-            case JLE:
-            case JGE: {
-                BytecodeOperand op_target = nextRawOperand();
-                if (debugMode)
+            OP(JE)
+            OP(JNE)
+            OP(JL)
+            OP(JG)
+            OP(JLE)
+            OP(JGE) {
+                const BytecodeOperand &op_target = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Target): "
                               << formatOperandDebug(op_target) << "\n";
-                if (op_target.type != OperandType::LABEL_ADDRESS &&
+                if (Checked && op_target.type != OperandType::LABEL_ADDRESS &&
                     op_target.type != OperandType::IMMEDIATE) {
-                    throw std::runtime_error("Conditional jump requires "
-                                             "immediate/label address operand");
+                    TRAP_MESSAGE("Conditional jump requires "
+                                 "immediate/label address operand");
                 }
-                bool shouldJump = false;
-                switch (opcode) {
-                case JE:
-                    shouldJump = zeroFlag;
-                    break;
-                case JNE:
-                    shouldJump = !zeroFlag;
-                    break;
-                case JL:
-                    shouldJump = signFlag;
-                    break;
-                case JG:
-                    shouldJump = !zeroFlag && !signFlag;
-                    break;
-                case JLE:
-                    shouldJump = zeroFlag || signFlag;
-                    break;
-                case JGE:
-                    shouldJump = zeroFlag || !signFlag;
-                    break;
-                default:
-                    break; // Should not happen
-                }
-                if (shouldJump) {
+                CHECK_RAM();
+                if (conditionHolds(opcode)) {
                     ip = op_target.value;
-                    if (debugMode)
+                    pc = !Checked || in->target >= 0 ? in->target : instructionIndex(ip);
+                    CHECK();
+                    if (Debug)
                         std::cout << "[Debug][Interpreter]     Condition met. "
                                      "Jumping to 0x"
                                   << std::hex << ip << std::dec << "\n";
                 } else {
-                    if (debugMode)
+                    if (Debug)
                         std::cout << "[Debug][Interpreter]     Condition not "
                                      "met. Continuing.\n";
                 }
-                break;
+                METER();
+                NEXT();
             }
 
-            case CALL: {
-                BytecodeOperand op_target = nextRawOperand();
-                if (debugMode)
+            OP(LOOP) {
+                const BytecodeOperand &op_counter = in->operands[0];
+                const BytecodeOperand &op_target = in->operands[1];
+                if (Debug)
+                    std::cout << "[Debug][Interpreter]   Op1(Counter): "
+                              << formatOperandDebug(op_counter)
+                              << "\n[Debug][Interpreter]   Op2(Target): "
+                              << formatOperandDebug(op_target) << "\n";
+                if (Checked && op_target.type != OperandType::LABEL_ADDRESS &&
+                    op_target.type != OperandType::IMMEDIATE) {
+                    TRAP_MESSAGE("LOOP requires immediate/label address operand");
+                }
+                int64_t count = toRegister(
+                    wrapSub(loadValue<Checked>(op_counter, wordSize), 1));
+                CHECK();
+                writeToOperand<Checked>(op_counter, count, wordSize);
+                CHECK();
+                CHECK_RAM();
+                if (count != 0) {
+                    ip = op_target.value;
+                    pc = !Checked || in->target >= 0 ? in->target : instructionIndex(ip);
+                    CHECK();
+                }
+                METER();
+                NEXT();
+            }
+            // Compare and branch (CJE, CJNE, CJL, CJG, CJLE, CJGE)
+            OP(CJE)
+            OP(CJNE)
+            OP(CJL)
+            OP(CJG)
+            OP(CJLE)
+            OP(CJGE) {
+                const BytecodeOperand &op1 = in->operands[0];
+                const BytecodeOperand &op2 = in->operands[1];
+                const BytecodeOperand &op_target = in->operands[2];
+                if (Debug)
+                    std::cout << "[Debug][Interpreter]   Op1: " << formatOperandDebug(op1)
+                              << "\n[Debug][Interpreter]   Op2: " << formatOperandDebug(op2)
+                              << "\n[Debug][Interpreter]   Op3(Target): "
+                              << formatOperandDebug(op_target) << "\n";
+                if (Checked && op_target.type != OperandType::LABEL_ADDRESS &&
+                    op_target.type != OperandType::IMMEDIATE) {
+                    TRAP_MESSAGE("Compare and branch requires "
+                                 "immediate/label address operand");
+                }
+                int64_t val1 = loadValue<Checked>(op1, wordSize);
+                int64_t val2 = loadValue<Checked>(op2, wordSize);
+                CHECK();
+                CHECK_RAM();
+                if (compareMet(opcode, val1, val2)) {
+                    ip = op_target.value;
+                    pc = !Checked || in->target >= 0 ? in->target : instructionIndex(ip);
+                    CHECK();
+                }
+                METER();
+                NEXT();
+            }
+
+            OP(JMPTAB) {
+                const BytecodeOperand &op_index = in->operands[0];
+                if (Debug)
+                    std::cout << "[Debug][Interpreter]   Op1(Index): "
+                              << formatOperandDebug(op_index)
+                              << "\n[Debug][Interpreter]   Op2(Table): "
+                              << formatOperandDebug(in->operands[1]) << "\n";
+                if (Checked && in->target < 0)
+                    TRAP_MESSAGE("JMPTAB requires the data address of a jump "
+                                 "table in RAM");
+                int64_t index = loadValue<Checked>(op_index, wordSize);
+                CHECK();
+                CHECK_RAM();
+                // An index outside the table falls through, like the default
+                // case of a switch
+                const DecodedJumpTable &table = image.jumpTables[in->target];
+                if (index >= 0 && index < (int64_t)table.targets.size()) {
+                    ip = table.offsets[index];
+                    pc = table.targets[index];
+                    if (Checked && pc == (size_t)-1) {
+                        setFault(Fault::BAD_JUMP_TARGET, ip);
+                        goto trap;
+                    }
+                    if (Debug)
+                        std::cout << "[Debug][Interpreter]     Entry " << index
+                                  << ", jumping to 0x" << std::hex << ip
+                                  << std::dec << "\n";
+                }
+                METER();
+                NEXT();
+            }
+
+            OP(CALL) {
+                const BytecodeOperand &op_target = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Target): "
                               << formatOperandDebug(op_target) << "\n";
-                if (op_target.type != OperandType::LABEL_ADDRESS &&
+                bool indirect = op_target.type == OperandType::REGISTER;
+                if (Checked && !indirect &&
+                    op_target.type != OperandType::LABEL_ADDRESS &&
                     op_target.type != OperandType::IMMEDIATE) {
-                    throw std::runtime_error(
-                        "CALL requires immediate/label address operand");
+                    TRAP_MESSAGE("CALL requires immediate/label address operand");
                 }
-                pushStack(ip); // Push return address (address AFTER call
+                // CALL reg: the register holds the function's code offset
+                int target = indirect ? ramAddress(loadValue<Checked>(op_target, wordSize))
+                                      : (int)op_target.value;
+                CHECK();
+                stackPush(ip); // Push return address (address AFTER call
                                // instruction + operands)
-                if (debugMode)
+                CHECK();
+                if (Debug)
                     std::cout
                         << "[Debug][Interpreter]     Pushing return address 0x"
                         << std::hex << ip << std::dec << ". Calling 0x"
-                        << std::hex << op_target.value << std::dec << "\n";
-                ip = op_target.value; // Jump to function
-                break;
+                        << std::hex << target << std::dec << "\n";
+                CHECK_RAM();
+                ip = target; // Jump to function
+                pc = !indirect && (!Checked || in->target >= 0) ? in->target
+                                                                : instructionIndex(ip);
+                CHECK();
+                METER();
+                NEXT();
             }
-            case RET: {
-                if (registers[7] >= ram.size())
-                    throw std::runtime_error("Stack underflow on RET");
-                int retAddr = popStack();
-                if (debugMode)
+            OP(RET) {
+                if (registers[7] >= ramBytes)
+                    TRAP(Fault::STACK_UNDERFLOW);
+                int retAddr = ramAddress(stackPop());
+                CHECK();
+                if (Debug)
                     std::cout
                         << "[Debug][Interpreter]     Popped return address 0x"
                         << std::hex << retAddr << std::dec << ". Returning.\n";
+                CHECK_RAM();
                 ip = retAddr; // Pop return address and jump
-                break;
+                pc = instructionIndex(ip);
+                CHECK();
+                METER();
+                NEXT();
             }
 
             // Stack Operations
-            case PUSH: {
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+            OP(PUSH) {
+                const BytecodeOperand &op_src = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Src): "
                               << formatOperandDebug(op_src) << "\n";
-                int val = getValue(op_src, 4);
-                pushStack(val); // Push value (reg or imm)
-                if (debugMode)
+                int64_t val = loadValue<Checked>(op_src, wordSize);
+                CHECK();
+                stackPush(val); // Push value (reg or imm)
+                CHECK();
+                if (Debug)
                     std::cout << "[Debug][Interpreter]     Pushed value " << val
-                              << ". New SP: 0x" << std::hex << sp << std::dec
+                              << ". New SP: 0x" << std::hex << registers[7] << std::dec
                               << "\n";
-                break;
+                NEXT();
             }
-            case POP: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(POP) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                int dest_reg = getRegisterIndex(op_dest);
-                int val = popStack();
+                int dest_reg = registerIndex<Checked>(op_dest);
+                CHECK();
+                int64_t val = stackPop();
+                CHECK();
                 registers[dest_reg] = val;
-                if (debugMode)
+                if (Debug)
                     std::cout << "[Debug][Interpreter]     Popped value " << val
                               << " into R" << dest_reg << ". New SP: 0x"
-                              << std::hex << sp << std::dec << "\n";
-                break;
+                              << std::hex << registers[7] << std::dec << "\n";
+                NEXT();
             }
 
             // I/O Operations
-            case OUT: {
-                BytecodeOperand op_port = nextRawOperand();
-                if (debugMode)
+            OP(OUT) {
+                const BytecodeOperand &op_port = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Port): "
                               << formatOperandDebug(op_port) << "\n";
-                BytecodeOperand op_val = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_val = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Val ): "
                               << formatOperandDebug(op_val) << "\n";
-                int port = getValue(op_port, 4);
+                int port = loadValue<Checked>(op_port, 4);
+                CHECK();
                 std::ostream &out_stream = (port == 2) ? std::cerr : std::cout;
                 if (port != 1 && port != 2)
-                    throw std::runtime_error("Invalid port for OUT: " +
-                                             std::to_string(port));
+                    TRAP_MESSAGE("Invalid port for OUT: " + std::to_string(port));
                 switch (op_val.type) {
                 case OperandType::DATA_ADDRESS: {
                     // Get the absolute RAM address (Base + Offset)
                     int address = op_val.value;
-                    if (address < 0 || address >= ram.size()) {
-                        throw std::runtime_error(
-                            "OUT: Data address out of RAM bounds: " +
-                            std::to_string(op_val.value));
+                    if (Checked && (address < 0 || address >= ramBytes)) {
+                        TRAP_MESSAGE("OUT: Data address out of RAM bounds: " +
+                                     std::to_string(op_val.value));
                     }
-                    out_stream << readRamString(address); // Read and print the string from RAM
-                    if (debugMode) dbg_output << readRamString(address); // Read and print the string from RAM
+                    std::string text = loadRamString(address);
+                    out_stream << text; // Print the string from RAM
+                    CHECK();
+                    if (Debug) dbg_output << text;
                     break;
                 }
                 case OperandType::REGISTER_AS_ADDRESS: {
                     int reg_index = op_val.value;
-                    if (reg_index < 0 || reg_index >= registers.size()) {
-                        throw std::runtime_error("OUT: Invalid register index "
-                                                 "for REGISTER_AS_ADDRESS: " +
-                                                 std::to_string(reg_index));
+                    if (Checked && (reg_index < 0 || reg_index >= registers.size())) {
+                        TRAP_MESSAGE("OUT: Invalid register index "
+                                     "for REGISTER_AS_ADDRESS: " +
+                                     std::to_string(reg_index));
                     }
-                    int address =
-                        registers[reg_index]; // Get address from register
-                    if (address < 0 || address >= ram.size()) {
-                        throw std::runtime_error(
-                            "OUT: Address in register R" +
-                            std::to_string(reg_index) + " (" +
-                            std::to_string(address) + ") is out of RAM bounds");
+                    int address = ramAddress(
+                        registers[reg_index]); // Get address from register
+                    if (address < 0 || address >= ramBytes) {
+                        TRAP_MESSAGE("OUT: Address in register R" +
+                                     std::to_string(reg_index) + " (" +
+                                     std::to_string(address) +
+                                     ") is out of RAM bounds");
                     }
-                    out_stream << readRamString(address); // Read and print the string from RAM
-                    if (debugMode) dbg_output << readRamString(address); // Read and print the string from RAM
+                    std::string text = loadRamString(address);
+                    out_stream << text; // Print the string from RAM
+                    CHECK();
+                    if (Debug) dbg_output << text;
                     break;
                 }
                 case OperandType::REGISTER: {
-                    int reg_val = registers[getRegisterIndex(op_val)];
+                    int reg_index = registerIndex<Checked>(op_val);
+                    CHECK();
+                    int64_t reg_val = registers[reg_index];
                     out_stream << reg_val; // Print the integer value in the register
-                    if (debugMode) dbg_output << reg_val;
+                    if (Debug) dbg_output << reg_val;
                     break;
                 }
                 case OperandType::IMMEDIATE: {
                     out_stream << op_val.value; // Print the immediate integer value
-                    if (debugMode) dbg_output << op_val.value; 
+                    if (Debug) dbg_output << op_val.value; 
                     break;
                 }
                 default:
-                    throw std::runtime_error(
-                        "Unsupported operand type for OUT value: " +
-                        std::to_string(static_cast<int>(op_val.type)));
+                    TRAP_MESSAGE("Unsupported operand type for OUT value: " +
+                                 std::to_string(static_cast<int>(op_val.type)));
                 }
-                break;
+                NEXT();
             }
-            case COUT: {
-                BytecodeOperand op_port = nextRawOperand();
-                if (debugMode)
+            OP(COUT) {
+                const BytecodeOperand &op_port = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Port): "
                               << formatOperandDebug(op_port) << "\n";
-                BytecodeOperand op_val = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_val = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Val ): "
                               << formatOperandDebug(op_val) << "\n";
-                int port = getValue(op_port, 4);
+                int port = loadValue<Checked>(op_port, 4);
+                CHECK();
                 std::ostream &out_stream = (port == 2) ? std::cerr : std::cout;
                 if (port != 1 && port != 2)
-                    throw std::runtime_error("Invalid port for COUT: " +
-                                             std::to_string(port));
-                out_stream << static_cast<char>(getValue(op_val, 4)); // Output char value
-                if (debugMode) dbg_output << static_cast<char>(getValue(op_val, 4));
-                break;
+                    TRAP_MESSAGE("Invalid port for COUT: " + std::to_string(port));
+                char c = static_cast<char>(loadValue<Checked>(op_val, 4));
+                CHECK();
+                out_stream << c; // Output char value
+                if (Debug) dbg_output << c;
+                NEXT();
             }
-            case OUTSTR: { // Prints string from RAM address IN REGISTER
-                BytecodeOperand op_port = nextRawOperand();
-                if (debugMode)
+            OP(OUTSTR) { // Prints string from RAM address IN REGISTER
+                const BytecodeOperand &op_port = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Port): "
                               << formatOperandDebug(op_port) << "\n";
-                BytecodeOperand op_addr = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_addr = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Addr): "
                               << formatOperandDebug(op_addr) << "\n";
-                BytecodeOperand op_len = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_len = in->operands[2];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op3(Len ): "
                               << formatOperandDebug(op_len) << "\n";
-                int port = getValue(op_port, 4);
+                int port = loadValue<Checked>(op_port, 4);
+                CHECK();
                 std::ostream &out_stream = (port == 2) ? std::cerr : std::cout;
                 if (port != 1 && port != 2)
-                    throw std::runtime_error("Invalid port for OUTSTR: " +
-                                             std::to_string(port));
-
-                int addr = getValue(op_addr, 4);
-                int len = getValue(op_len, 4);
-                for (int i = 0; i < len; ++i) {
-                    out_stream << readRamChar(addr + i); // Read char by char
-                    if (debugMode) dbg_output << readRamChar(addr + i);
+                    TRAP_MESSAGE("Invalid port for OUTSTR: " + std::to_string(port));
+
+                int addr = ramAddress(loadValue<Checked>(op_addr, 4));
+                int64_t len = loadValue<Checked>(op_len, 4);
+                CHECK();
+                for (int64_t i = 0; i < len; ++i) {
+                    char c = loadRamChar(addr + i); // Read char by char
+                    CHECK();
+                    out_stream << c;
+                    if (Debug) dbg_output << c;
                 }
                 // No automatic newline for OUTSTR
-                break;
+                NEXT();
             }
-            case OUTCHAR: { // Prints single char from RAM address IN REGISTER
-                BytecodeOperand op_port = nextRawOperand();
-                if (debugMode)
+            OP(OUTCHAR) { // Prints single char from RAM address IN REGISTER
+                const BytecodeOperand &op_port = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Port): "
                               << formatOperandDebug(op_port) << "\n";
-                BytecodeOperand op_addr = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_addr = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Addr): "
                               << formatOperandDebug(op_addr) << "\n";
-                int port = getValue(op_port, 4);
+                int port = loadValue<Checked>(op_port, 4);
+                CHECK();
                 std::ostream &out_stream = (port == 2) ? std::cerr : std::cout;
                 if (port != 1 && port != 2)
-                    throw std::runtime_error("Invalid port for OUTCHAR: " +
-                                             std::to_string(port));
-
-                int addr = getValue(op_addr, 4);
-                out_stream << readRamChar(addr); // Read single char
-                if (debugMode) dbg_output << readRamChar(addr);
+                    TRAP_MESSAGE("Invalid port for OUTCHAR: " + std::to_string(port));
+
+                int addr = ramAddress(loadValue<Checked>(op_addr, 4));
+                CHECK();
+                char c = loadRamChar(addr); // Read single char
+                CHECK();
+                out_stream << c;
+                if (Debug) dbg_output << c;
                 // No automatic newline for OUTCHAR
-                break;
+                NEXT();
             }
-            case IN: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(IN) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
 
@@ -1285,39 +2545,43 @@ void Interpreter::execute() {
                 std::getline(std::cin, input);
 
                 // Write input and null terminator to memory
-                std::copy(input.begin(), input.end(), ram.begin() + getRamAddr(op_dest));
-                ram[getRamAddr(op_dest) + input.size()] = '\0';
-                break;
+                int address = getRamAddr(op_dest);
+                CHECK();
+                std::copy(input.begin(), input.end(), ram.begin() + address);
+                ram[address + input.size()] = '\0';
+                NEXT();
             }
 
             // Program Control
-            case HLT: {
-                if (debugMode)
+            OP(HLT) {
+                if (Debug)
                     std::cout << "[Debug][Interpreter] HLT encountered.\n";
                 exit = true; // exit loop
-                break;
+                NEXT();
             } // Halt execution
-            case ARGC: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(ARGC) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                writeToOperand(op_dest, cmdArgs.size(), 4); // Use cmdArgs member
-                break;
+                writeToOperand<Checked>(op_dest, cmdArgs.size(), 4); // Use cmdArgs member
+                CHECK();
+                NEXT();
             }
-            case GETARG: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(GETARG) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_index = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_index = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Index): "
                               << formatOperandDebug(op_index) << "\n";
-                int index = getValue(op_index, 4);
-                if (index < 0 || index >= cmdArgs.size()) {
-                    throw std::runtime_error("GETARG index out of bounds: " +
-                                             std::to_string(index));
+                int64_t index = loadValue<Checked>(op_index, 4);
+                CHECK();
+                if (index < 0 || index >= (int64_t)cmdArgs.size()) {
+                    TRAP_MESSAGE("GETARG index out of bounds: " +
+                                 std::to_string(index));
                 }
                 // How to store string arg in int register? Store address.
                 // Need to copy string to RAM and store address.
@@ -1325,446 +2589,632 @@ void Interpreter::execute() {
                 // management.
                 // Update: WE HAVE MEMORY MANAGMENT NOW YIPPIE. time to implement this --carson
                 // code is expected to free memory
-                int str_addr = mmalloc(cmdArgs[index].length());
+                int str_addr = heap.mmalloc(cmdArgs[index].length() + 1);
 
-                writeToOperand(op_dest, str_addr, 4);
+                writeToOperand<Checked>(op_dest, str_addr, 4);
+                CHECK();
+                if (str_addr < 0) { // heap error code, like MALLOC
+                    setCompare(str_addr, 0);
+                    NEXT();
+                }
 
                 std::copy(cmdArgs[index].begin(), cmdArgs[index].end(), ram.begin() + str_addr);
                 ram[str_addr + cmdArgs[index].size()] = '\0';
-                break;
+                NEXT();
             }
 
             // Bitwise Operations
-            case AND: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(AND) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_dest, 4)&getValue(op_src, 4), 4);
-                break;
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                int64_t src = loadValue<Checked>(op_src, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, dest & src, wordSize);
+                CHECK();
+                NEXT();
             }
-            case OR: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(OR) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_dest, 4)|getValue(op_src, 4), 4);
-                break;
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                int64_t src = loadValue<Checked>(op_src, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, dest | src, wordSize);
+                CHECK();
+                NEXT();
             }
-            case XOR: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(XOR) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                writeToOperand(op_dest, getValue(op_dest, 4)^getValue(op_src, 4), 4);
-                break;
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                int64_t src = loadValue<Checked>(op_src, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, dest ^ src, wordSize);
+                CHECK();
+                NEXT();
             }
-            case NOT: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(NOT) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                writeToOperand(op_dest, ~getValue(op_dest, 4), 4);
-                break;
+                int64_t value = loadValue<Checked>(op_dest, wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, ~value, wordSize);
+                CHECK();
+                NEXT();
             }
-            case SHL: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(SHL) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_count = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_count = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Count): "
                               << formatOperandDebug(op_count) << "\n";
-                writeToOperand(op_dest, getValue(op_dest, 4)<<getValue(op_count, 2), 4);
-                break;
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                int count = loadValue<Checked>(op_count, 2) & shiftMask;
+                CHECK();
+                writeToOperand<Checked>(op_dest, (int64_t)((uint64_t)dest << count),
+                                        wordSize);
+                CHECK();
+                NEXT();
             }
-            case SHR: {
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(SHR) {
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_count = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_count = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Count): "
                               << formatOperandDebug(op_count) << "\n";
-                writeToOperand(op_dest, getValue(op_dest, 4)>>getValue(op_count, 4), 4);
-                break;
+                int64_t dest = loadValue<Checked>(op_dest, wordSize);
+                int count = loadValue<Checked>(op_count, 4) & shiftMask;
+                CHECK();
+                writeToOperand<Checked>(op_dest, dest >> count, wordSize);
+                CHECK();
+                NEXT();
             } // Arithmetic right shift
 
             // Memory Addressing
-            case MOVADDR: { // MOVADDR dest_reg src_addr_reg offset_reg
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(MOVADDR) { // MOVADDR dest_reg src_addr_reg offset_reg
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src_addr = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src_addr = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(SrcAddr): "
                               << formatOperandDebug(op_src_addr) << "\n";
-                BytecodeOperand op_offset = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_offset = in->operands[2];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op3(Offset): "
                               << formatOperandDebug(op_offset) << "\n";
-                int address = getValue(op_src_addr, 4) + getValue(op_offset, 4);
-                writeToOperand(op_dest, readRamInt(address), 4);
-                break;
+                int64_t base = loadValue<Checked>(op_src_addr, 4);
+                int64_t offset = loadValue<Checked>(op_offset, 4);
+                CHECK();
+                int64_t value = loadRamNum(ramAddress(base + offset), wordSize);
+                CHECK();
+                writeToOperand<Checked>(op_dest, value, wordSize);
+                CHECK();
+                NEXT();
             }
-            case MOVTO: { // MOVTO dest_addr_reg offset_reg src_reg
-                BytecodeOperand op_dest_addr = nextRawOperand();
-                if (debugMode)
+            OP(MOVTO) { // MOVTO dest_addr_reg offset_reg src_reg
+                const BytecodeOperand &op_dest_addr = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(DestAddr): "
                               << formatOperandDebug(op_dest_addr) << "\n";
-                BytecodeOperand op_offset = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_offset = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Offset): "
                               << formatOperandDebug(op_offset) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[2];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op3(Src): "
                               << formatOperandDebug(op_src) << "\n";
-                int address = getValue(op_dest_addr, 4) + getValue(op_offset, 4);
-                writeRamInt(address, getValue(op_src, 4));
-                break;
+                int64_t base = loadValue<Checked>(op_dest_addr, 4);
+                int64_t offset = loadValue<Checked>(op_offset, 4);
+                int64_t value = loadValue<Checked>(op_src, wordSize);
+                CHECK();
+                storeRamNum(ramAddress(base + offset), value, wordSize);
+                CHECK();
+                NEXT();
             }
 
             // Stack Frame Management
-            case ENTER: { // ENTER framesize (immediate)
-                BytecodeOperand op_frameSize = nextRawOperand();
-                if (debugMode)
+            OP(ENTER) { // ENTER framesize (immediate)
+                const BytecodeOperand &op_frameSize = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(FrameSize): "
                               << formatOperandDebug(op_frameSize) << "\n";
-                int frameSize = getValue(op_frameSize, 4);
-                pushStack(registers[6]);     // Push RBP
+                int64_t frameSize = loadValue<Checked>(op_frameSize, 4);
+                CHECK();
+                stackPush(registers[6]);     // Push RBP
+                CHECK();
                 registers[6] = registers[7]; // MOV RBP, RSP
-                bp = registers[6];
                 registers[7] -=
                     frameSize; // SUB RSP, framesize // (PUSH 0) * framesize
-                sp = registers[7];
-                break;
+                NEXT();
             }
-            case LEAVE: {                    // LEAVE
+            OP(LEAVE) {                    // LEAVE
                 registers[7] = registers[6]; // MOV RSP, RBP
-                sp = registers[7];
-                registers[6] = popStack(); // POP RBP
-                bp = registers[6];
-                break;
+                int64_t rbp = stackPop(); // POP RBP
+                CHECK();
+                registers[6] = rbp;
+                NEXT();
             }
 
             // String/Memory Operations
-            case COPY: { // COPY dest_addr_reg src_addr_reg len_reg
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(COPY) { // COPY dest_addr_reg src_addr_reg len_reg
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_src = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_src = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Src ): "
                               << formatOperandDebug(op_src) << "\n";
-                BytecodeOperand op_len = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_len = in->operands[2];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op3(Len ): "
                               << formatOperandDebug(op_len) << "\n";
-                int dest_addr = getValue(op_dest, 4);
-                int src_addr = getValue(op_src, 4);
-                int len = getValue(op_len, 4);
+                int64_t dest_addr = loadValue<Checked>(op_dest, 4);
+                int64_t src_addr = loadValue<Checked>(op_src, 4);
+                int64_t len = loadValue<Checked>(op_len, 4);
+                CHECK();
                 if (len < 0)
-                    throw std::runtime_error("COPY length cannot be negative");
-                if (dest_addr < 0 || dest_addr + len > ram.size() ||
-                    src_addr < 0 || src_addr + len > ram.size()) {
-                    throw std::runtime_error(
-                        "COPY memory access out of bounds");
+                    TRAP_MESSAGE("COPY length cannot be negative");
+                if (dest_addr < 0 || dest_addr > (int64_t)ramBytes ||
+                    len > (int64_t)ramBytes - dest_addr || src_addr < 0 ||
+                    src_addr > (int64_t)ramBytes || len > (int64_t)ramBytes - src_addr) {
+                    TRAP_MESSAGE("COPY memory access out of bounds");
                 }
                 // Use memcpy directly (it's in the global namespace via
                 // <cstring>)
                 memcpy(&ram[dest_addr], &ram[src_addr], len);
-                break;
+                NEXT();
             }
-            case FILL: { // FILL dest_addr_reg value_reg len_reg
-                BytecodeOperand op_dest = nextRawOperand();
-                if (debugMode)
+            OP(FILL) { // FILL dest_addr_reg value_reg len_reg
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Dest): "
                               << formatOperandDebug(op_dest) << "\n";
-                BytecodeOperand op_val = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_val = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Val ): "
                               << formatOperandDebug(op_val) << "\n";
-                BytecodeOperand op_len = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_len = in->operands[2];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op3(Len ): "
                               << formatOperandDebug(op_len) << "\n";
-                int dest_addr = getValue(op_dest, 4);
+                int64_t dest_addr = loadValue<Checked>(op_dest, 4);
                 int value =
-                    getValue(op_val, 4) & 0xFF; // Use lower byte of value register
-                int len = getValue(op_len, 4);
+                    loadValue<Checked>(op_val, 4) & 0xFF; // Use lower byte of value register
+                int64_t len = loadValue<Checked>(op_len, 4);
+                CHECK();
                 if (len < 0)
-                    throw std::runtime_error("FILL length cannot be negative");
-                if (dest_addr < 0 || dest_addr + len > ram.size()) {
-                    throw std::runtime_error(
-                        "FILL memory access out of bounds");
+                    TRAP_MESSAGE("FILL length cannot be negative");
+                if (dest_addr < 0 || dest_addr > (int64_t)ramBytes ||
+                    len > (int64_t)ramBytes - dest_addr) {
+                    TRAP_MESSAGE("FILL memory access out of bounds");
                 }
                 // Use memset directly
                 memset(&ram[dest_addr], value, len);
-                break;
+                NEXT();
             }
-            case CMP_MEM: { // CMP_MEM addr1_reg addr2_reg len_reg
-                BytecodeOperand op_addr1 = nextRawOperand();
-                if (debugMode)
+            OP(VADDB) OP(VADDW) OP(VADDD) OP(VSUBB) OP(VSUBW) OP(VSUBD)
+            OP(VMULB) OP(VMULW) OP(VMULD) OP(VMINB) OP(VMINW) OP(VMIND)
+            OP(VMAXB) OP(VMAXW) OP(VMAXD) OP(VSUMB) OP(VSUMW) OP(VSUMD)
+            OP(VDOTB) OP(VDOTW) OP(VDOTD) {
+                // VADD..VMAX dest_addr src_addr len, VSUM len src_addr,
+                // VDOT len a_addr b_addr
+                if (Debug)
+                    for (int i = 0; i < in->operandCount; i++)
+                        std::cout << "[Debug][Interpreter]   Op" << i + 1 << ": "
+                                  << formatOperandDebug(in->operands[i]) << "\n";
+                int kind = (opcode - VADDB) / 3; // VectorOp, then VSUM, VDOT
+                int width = vectorWidth(opcode);
+                bool reduce = kind > (int)VectorOp::MAX;
+                const BytecodeOperand &op_len = in->operands[reduce ? 0 : 2];
+                const BytecodeOperand &op_a = in->operands[reduce ? 1 : 0];
+                const BytecodeOperand &op_b = in->operands[reduce ? 2 : 1];
+                int64_t len = loadValue<Checked>(op_len, wordSize);
+                int64_t a = loadValue<Checked>(op_a, wordSize);
+                int64_t b = opcode >= VSUMB && opcode <= VSUMD
+                                ? a
+                                : loadValue<Checked>(op_b, wordSize);
+                CHECK();
+                if (len < 0)
+                    TRAP_MESSAGE("Vector length cannot be negative");
+                // Compared by division: a wide register can hold an address
+                // or a length that overflows a + len * width
+                if (a < 0 || a > (int64_t)ramBytes || len > ((int64_t)ramBytes - a) / width ||
+                    b < 0 || b > (int64_t)ramBytes || len > ((int64_t)ramBytes - b) / width) {
+                    TRAP_MESSAGE("Vector memory access out of bounds");
+                }
+                uint8_t *base = reinterpret_cast<uint8_t *>(ram.data());
+                if (!reduce) {
+                    vectorBinary((VectorOp)kind, width, base + a, base + b, len);
+                } else {
+                    int64_t result = opcode <= VSUMD ? vectorSum(width, base + a, len)
+                                                     : vectorDot(width, base + a, base + b, len);
+                    writeToOperand<Checked>(op_len, result, wordSize);
+                    CHECK();
+                }
+                NEXT();
+            }
+            OP(CMP_MEM) { // CMP_MEM addr1_reg addr2_reg len_reg
+                const BytecodeOperand &op_addr1 = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(Addr1): "
                               << formatOperandDebug(op_addr1) << "\n";
-                BytecodeOperand op_addr2 = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_addr2 = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(Addr2): "
                               << formatOperandDebug(op_addr2) << "\n";
-                BytecodeOperand op_len = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_len = in->operands[2];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op3(Len ): "
                               << formatOperandDebug(op_len) << "\n";
-                int addr1 = getValue(op_addr1, 4);
-                int addr2 = getValue(op_addr2, 4);
-                int len = getValue(op_len, 4);
+                int64_t addr1 = loadValue<Checked>(op_addr1, 4);
+                int64_t addr2 = loadValue<Checked>(op_addr2, 4);
+                int64_t len = loadValue<Checked>(op_len, 4);
+                CHECK();
                 if (len < 0)
-                    throw std::runtime_error(
-                        "CMP_MEM length cannot be negative");
-                if (addr1 < 0 || addr1 + len > ram.size() || addr2 < 0 ||
-                    addr2 + len > ram.size()) {
-                    throw std::runtime_error(
-                        "CMP_MEM memory access out of bounds");
+                    TRAP_MESSAGE("CMP_MEM length cannot be negative");
+                if (addr1 < 0 || addr1 > (int64_t)ramBytes || len > (int64_t)ramBytes - addr1 ||
+                    addr2 < 0 || addr2 > (int64_t)ramBytes || len > (int64_t)ramBytes - addr2) {
+                    TRAP_MESSAGE("CMP_MEM memory access out of bounds");
                 }
                 // Use memcmp directly
                 int result = memcmp(&ram[addr1], &ram[addr2], len);
-                zeroFlag = (result == 0);
-                signFlag = (result < 0);
-                break;
+                setCompare(result, 0);
+                NEXT();
             }
-            case MALLOC: { // MALLOC ptr_reg size
-                BytecodeOperand op_ptr = nextRawOperand();
-                if (debugMode)
+            OP(MALLOC) { // MALLOC ptr_reg size
+                const BytecodeOperand &op_ptr = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(ptr): "
                               << formatOperandDebug(op_ptr) << "\n";
-                BytecodeOperand op_size = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_size = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(size): "
                               << formatOperandDebug(op_size) << "\n";
 
-                int size = getValue(op_size, 4);
-
-                int result = mmalloc(size);
-
-                writeToOperand(op_ptr, result, 4);
+                int64_t size = loadValue<Checked>(op_size, 4);
+                CHECK();
+
+                // A wide register can ask for more than an int holds, which
+                // must not be truncated to a small request
+                int result;
+                if (size <= 0)
+                    result = HEAP_ERR_INVALID_ARG;
+                else if (size != (int)size)
+                    result = HEAP_ERR_OUT_OF_SPACE;
+                else
+                    result = heap.mmalloc(size);
+
+                writeToOperand<Checked>(op_ptr, result, 4);
+                CHECK();
                 
-                zeroFlag = (result == 0);
-                signFlag = (result < 0);
-                break;
+                setCompare(result, 0);
+                NEXT();
             }
-            case FREE: { // FREE result ptr
-                BytecodeOperand op_result = nextRawOperand();
-                if (debugMode)
+            OP(FREE) { // FREE result ptr
+                const BytecodeOperand &op_result = in->operands[0];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op1(result): "
                               << formatOperandDebug(op_result) << "\n";
-                BytecodeOperand op_ptr = nextRawOperand();
-                if (debugMode)
+                const BytecodeOperand &op_ptr = in->operands[1];
+                if (Debug)
                     std::cout << "[Debug][Interpreter]   Op2(ptr): "
                               << formatOperandDebug(op_ptr) << "\n";
 
-                int ptr = getValue(op_ptr, 4);
+                int64_t ptr = loadValue<Checked>(op_ptr, 4);
+                CHECK();
 
-                int result = mfree(ptr);
+                int result = HEAP_ERR_NOT_ALLOCATED;
+                if (ptr == (int)ptr)
+                    result = heap.mfree(ptr);
 
-                writeToOperand(op_result, result, 4);
+                writeToOperand<Checked>(op_result, result, 4);
+                CHECK();
                 
-                zeroFlag = (result == 0);
-                signFlag = (result < 0);
-                break;
+                setCompare(result, 0);
+                NEXT();
             }
+            OP(SBRK) { // SBRK old_break increment
+                const BytecodeOperand &op_dest = in->operands[0];
+                if (Debug)
+                    std::cout << "[Debug][Interpreter]   Op1(dest): "
+                              << formatOperandDebug(op_dest) << "\n";
+                const BytecodeOperand &op_increment = in->operands[1];
+                if (Debug)
+                    std::cout << "[Debug][Interpreter]   Op2(increment): "
+                              << formatOperandDebug(op_increment) << "\n";
+
+                int64_t increment = loadValue<Checked>(op_increment, 4);
+                CHECK();
+
+                int result = HEAP_ERR_OUT_OF_SPACE;
+                if (increment == (int)increment)
+                    result = heap.msbrk(increment);
+
+                writeToOperand<Checked>(op_dest, result, 4);
+                CHECK();
 
-            case MNI: {
-                std::string functionName =
-                    readBytecodeString(); // Read Module.Function\0
-                if (debugMode)
+                setCompare(result, 0);
+                NEXT();
+            }
+
+            OP(MNI) {
+                const DecodedMni &call = image.mniCalls[in->target];
+                if (Debug) {
                     std::cout
-                        << "[Debug][Interpreter]   MNI Func: " << functionName
+                        << "[Debug][Interpreter]   MNI Func: " << call.name
                         << "\n";
-                std::vector<BytecodeOperand> mniArgs;
-                while (true) {
-                    BytecodeOperand arg = nextRawOperand();
-                    if (arg.type == OperandType::NONE) {
-                        if (debugMode)
-                            std::cout
-                                << "[Debug][Interpreter]     End MNI Args\n";
-                        break; // End of arguments marker
-                    }
-                    if (debugMode)
+                    for (const auto &arg : call.args)
                         std::cout << "[Debug][Interpreter]     MNI Arg : "
                                   << formatOperandDebug(arg) << "\n";
-                    mniArgs.push_back(arg);
+                    std::cout << "[Debug][Interpreter]     End MNI Args\n";
                 }
-                if (mniRegistry.count(functionName)) {
-                    mniRegistry[functionName](
-                        *this,
-                        mniArgs); // Call the registered function
-                } else {
-                    throw std::runtime_error(
-                        "Unregistered MNI function called: " + functionName);
+                // MNI functions report errors by throwing; this is the only
+                // place the loop has to catch them.
+                try {
+                    (*call.function)(*this, call.args); // Bound by load()
+                } catch (const std::exception &e) {
+                    TRAP_MESSAGE(e.what());
                 }
-                break;
+                NEXT();
             }
 
-            default:
-                throw std::runtime_error("Unimplemented or unknown opcode "
-                                         "encountered during execution: 0x" +
-                                         std::to_string(opcode));
-            }
-
-            // Optional: Print changed registers
-            if (debugMode) {
-                for (size_t i = 0; i < registers.size(); ++i) {
-                    if (registers[i] != regsBefore[i]) {
-                        std::cout << "[Debug][Interpreter]     Reg Change: R"
-                                  << i << " = " << registers[i] << " (was "
-                                  << regsBefore[i] << ")\n";
-                    }
+            // Superinstructions (see fuseSuperinstructions())
+            OP(OP_CMP_JCC) {
+                fusionHits[OP_CMP_JCC - OP_FUSED_FIRST]++;
+                int64_t val1 = loadValue<Checked>(in->operands[0], wordSize);
+                int64_t val2 = loadValue<Checked>(in->operands[1], wordSize);
+                CHECK();
+                setCompare(val1, val2);
+                STEP();
+                CHECK_RAM();
+                if (compareMet(opcode, val1, val2)) {
+                    ip = in->operands[0].value;
+                    pc = in->target;
                 }
-                // Print flag changes if CMP or relevant instruction executed
-                // (Requires tracking if flags were potentially modified by the
-                // opcode)
+                METER();
+                NEXT();
             }
-
-        } catch (const std::exception &e) {
-            // Print MNI stack trace if any
-
-            if (!mniCallStack.empty()) {
-                std::cerr << "MNI Call Stack (most recent call last):\n";
-                for (auto it = mniCallStack.rbegin(); it != mniCallStack.rend();
-                     ++it) {
-                    std::cerr << "  at " << *it << std::endl;
+            OP(OP_INC_CMP_JCC) {
+                fusionHits[OP_INC_CMP_JCC - OP_FUSED_FIRST]++;
+                int64_t &counter = registers[in->operands[0].value];
+                counter = toRegister(wrapAdd(counter, 1));
+                STEP();
+                int64_t val1 = loadValue<Checked>(in->operands[0], wordSize);
+                int64_t val2 = loadValue<Checked>(in->operands[1], wordSize);
+                CHECK();
+                setCompare(val1, val2);
+                STEP();
+                CHECK_RAM();
+                if (compareMet(opcode, val1, val2)) {
+                    ip = in->operands[0].value;
+                    pc = in->target;
                 }
+                METER();
+                NEXT();
             }
-            std::cerr << "\nRuntime Error at bytecode offset 0x" << std::hex
-                      << currentIp << std::dec << " (Opcode: 0x" << std::hex
-                      << static_cast<int>(opcode) << std::dec
-                      << "): " << e.what() << std::endl;
-            // Stack trace if -t or --trace
-            if (stackTrace) {
-                std::cerr << "\nStack Trace (most recent call first):\n";
-                struct stack_frame frame;
-                frame.rbp = registers[6]; // ebp
-                frame.ip = ip;
-
-                while (frame.rbp != 0) {
-                    std::cerr << getAddr(frame.ip, lbls) << std::endl;
-                    frame.ip = readRamInt(frame.rbp + 4);
-                    frame.rbp = readRamInt(frame.rbp);
-                }
-                std::cerr << "\n";
-            }
-            static const char *regNames[24] = {
-
-                "RAX", "RBX", "RCX", "RDX", "RSI",
-                "RDI", "RBP", "RSP",
-
-                "R0",  "R1",  "R2",  "R3",  "R4",
-                "R5",  "R6",  "R7",
-
-                "R8",  "R9",  "R10", "R11", "R12",
-                "R13", "R14", "R15"
-
-            };
-
-            // Dump registers with names and color
-            std::cerr << "Register dump:\n";
-            // Dump registers as an ASCII box (8 per row)
-            const int regsPerRow = 8;
-            const int totalRegs = registers.size();
-            const int rows = (totalRegs + regsPerRow - 1) / regsPerRow;
-            const int colWidth = 12; // Match hex value width
-            std::cerr << "+"
-                      << std::string(regsPerRow * (colWidth + 1) - 1, '-')
-                      << "+\n";
-            for (int row = 0; row < rows; ++row) {
-                // Header row: register names (centered, colWidth chars)
-                std::cerr << "|";
-                for (int col = 0; col < regsPerRow; ++col) {
-                    int idx = row * regsPerRow + col;
-                    if (idx < totalRegs) {
-                        std::string color;
-                        if (idx == 0)
-                            color = "\033[1;33m"; // RAX: yellow
-                        else if (idx == 6 || idx == 7)
-                            color = "\033[1;36m"; // RBP/RSP: cyan
-                        else
-                            color = "\033[1m";
-                        std::string name = regNames[idx];
-                        int pad = colWidth - name.length();
-                        int left = pad / 2, right = pad - left;
-                        std::cerr << color << std::string(left, ' ') << name
-                                  << std::string(right, ' ') << "\033[0m"
-                                  << "|";
-                    } else {
-                        std::cerr << std::string(colWidth, ' ') << "|";
-                    }
+            OP(OP_PUSH_FRAME) {
+                fusionHits[OP_PUSH_FRAME - OP_FUSED_FIRST]++;
+                stackPush(registers[6]);
+                CHECK();
+                STEP();
+                registers[6] = registers[7];
+                NEXT();
+            }
+            OP(OP_LEAVE_RET) {
+                fusionHits[OP_LEAVE_RET - OP_FUSED_FIRST]++;
+                registers[7] = registers[6];
+                int64_t rbp = stackPop();
+                CHECK();
+                registers[6] = rbp;
+                STEP();
+                if (registers[7] >= ramBytes)
+                    TRAP(Fault::STACK_UNDERFLOW);
+                ip = ramAddress(stackPop());
+                CHECK();
+                CHECK_RAM();
+                pc = instructionIndex(ip);
+                CHECK();
+                METER();
+                NEXT();
+            }
+            OP(OP_POP_FRAME_RET) {
+                fusionHits[OP_POP_FRAME_RET - OP_FUSED_FIRST]++;
+                registers[7] = registers[6];
+                STEP();
+                int64_t rbp = stackPop();
+                CHECK();
+                registers[6] = rbp;
+                STEP();
+                if (registers[7] >= ramBytes)
+                    TRAP(Fault::STACK_UNDERFLOW);
+                ip = ramAddress(stackPop());
+                CHECK();
+                CHECK_RAM();
+                pc = instructionIndex(ip);
+                CHECK();
+                METER();
+                NEXT();
+            }
+
+            // Operand-kind specialized handlers (see specializedHandler())
+#define SPECIALIZED(name)                                                      \
+            OP(OP_##name##_REG_REG) {                                          \
+                executeSpecialized<name, OperandType::REGISTER>(*in);          \
+                NEXT();                                                        \
+            }                                                                  \
+            OP(OP_##name##_REG_IMM) {                                          \
+                executeSpecialized<name, OperandType::IMMEDIATE>(*in);         \
+                NEXT();                                                        \
+            }
+            MASM_FOR_EACH_SPECIALIZED_OPCODE(SPECIALIZED)
+#undef SPECIALIZED
+            OP(OP_LOOP_REG) {
+                int64_t &counter = registers[in->operands[0].value];
+                counter = toRegister(wrapSub(counter, 1));
+                CHECK_RAM();
+                if (counter != 0) {
+                    ip = in->operands[1].value;
+                    pc = in->target;
                 }
-                std::cerr << "\n|";
-                // Value row: decimal values (colWidth chars)
-                for (int col = 0; col < regsPerRow; ++col) {
-                    int idx = row * regsPerRow + col;
-                    if (idx < totalRegs) {
-                        std::cerr << std::setw(colWidth - 1) << registers[idx]
-                                  << " |";
-                    } else {
-                        std::cerr << std::string(colWidth, ' ') << "|";
-                    }
+                METER();
+                NEXT();
+            }
+            OP(OP_CJCC_REG_REG)
+            OP(OP_CJCC_REG_IMM) {
+                int64_t lhs = registers[in->operands[0].value];
+                int64_t rhs = in->operands[1].type == OperandType::REGISTER
+                                  ? registers[in->operands[1].value]
+                                  : (int64_t)in->operands[1].value;
+                CHECK_RAM();
+                if (compareMet(opcode, lhs, rhs)) {
+                    ip = in->operands[2].value;
+                    pc = in->target;
                 }
+                METER();
+                NEXT();
+            }
 
-                std::cerr << "\n|";
-                // Value row: hex values (colWidth chars)
-                for (int col = 0; col < regsPerRow; ++col) {
-                    int idx = row * regsPerRow + col;
-                    if (idx < totalRegs) {
-                        std::stringstream hexss;
-                        hexss << "0x" << std::hex << std::setw(8)
-                              << std::setfill('0') << registers[idx]
-                              << std::dec;
-                        std::string hexval = hexss.str();
-                        int pad = colWidth - hexval.length();
-                        int left = pad / 2, right = pad - left;
-                        std::cerr << std::string(left, ' ') << hexval
-                                  << std::string(right, ' ') << "|";
-                    } else {
-                        std::cerr << std::string(colWidth, ' ') << "|";
-                    }
-                }
+            OP(OP_JIT_BLOCK) {
+                JitContext context;
+                context.registers = registers.data();
+                context.zeroFlag = getZeroFlag();
+                context.signFlag = getSignFlag();
+                // Native loops stop once the rest of the budget is used
+                context.budget = executed - 1 < budget ? budget - (executed - 1) : 0;
+                auto start = std::chrono::steady_clock::now();
+                pc = jitBlocks[pc - 1](&context);
+                nativeSeconds += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+                executed += context.executed - 1; // FETCH counted the first one
+                setFlags(context.zeroFlag, context.signFlag);
+                jitEntries++;
+                if (pc >= programSize)
+                    ip = codeSize;
+                METER();
+                NEXT();
+            }
 
-                std::cerr << "\n+"
-                          << std::string(regsPerRow * (colWidth + 1) - 1, '-')
-                          << "+\n";
+            OP(OP_HOT_COUNTER) {
+                uint8_t next = image.fast[pc - 1];
+                if (++hotCounts[pc - 1] >= JIT_HOT_THRESHOLD)
+                    next = promoteBlock(pc - 1);
+                REDISPATCH(next);
             }
 
-            std::cerr << "  ZF=" << zeroFlag << ", SF=" << signFlag << "\n";
+            OP(OP_DECODE_FAULT)
+                TRAP_MESSAGE(decodeError);
 
-            std::cerr << "\n";
-            // std::cerr << "\033[1;33mRAX\033[0m, \033[1;36mRBP/RSP\033[0m:
-            // special "
-            //              "registers\n";
+            OP_DEFAULT
+                TRAP_MESSAGE("Unimplemented or unknown opcode "
+                             "encountered during execution: 0x" +
+                             std::to_string(opcode));
 
-            check_unfreed_memory(true); // cleanup heap
-            throw; // Re-throw after logging context
+            END_DISPATCH()
         }
     }
-    check_unfreed_memory(); // cleanup memory and print unfreed memory
-    if (debugMode) debugger(true); // Allow for some last minute commands
+
+trap: {
+    // Every fault leaves the loop here. Build the message, report it and
+    // throw it to the caller from outside the handlers.
+    std::string message = faultMessage();
+    trapCode = fault;
+    trapIp = currentIp;
+    fault = Fault::NONE;
+    instructionsExecuted = executedBefore + executed;
+    reportFault(Trace, currentIp, opcode, message);
+    throw std::runtime_error(message);
+}
+suspend:
+    // Out of budget. Leave ip on the next instruction so the following
+    // call picks up from there.
+    ip = pc < programSize ? program[pc].offset : codeSize;
+    instructionsExecuted = executedBefore + executed;
+    suspended = true;
+    return ExecutionStatus::SUSPENDED;
+done:
+    CHECK_RAM();
+#undef FETCH
+#undef STEP
+#undef HANDLER_OF
+#undef OP
+#undef OP_DEFAULT
+#undef NEXT
+#undef DISPATCH
+#undef REDISPATCH
+#undef END_DISPATCH
+#undef CHECK
+#undef TRAP
+#undef TRAP_MESSAGE
+#undef CHECK_RAM
+#undef METER
+    instructionsExecuted = executedBefore + executed;
+    heap.check_unfreed_memory(); // cleanup memory and print unfreed memory
+    if (Debug) debugger(true); // Allow for some last minute commands
+    return ExecutionStatus::HALTED;
+}
+
+void Interpreter::execute() {
+    execute(UINT64_MAX);
+}
+
+ExecutionStatus Interpreter::execute(uint64_t budget) {
+    ram.touch();
+    if (jitEnabled && !debugMode && jitBlocks.empty())
+        prepareTiering();
+    auto start = std::chrono::steady_clock::now();
+    ExecutionStatus status;
+    // Pick the loop once so the release build never tests debugMode per
+    // instruction, and verified programs skip the operand checks.
+    if (debugMode) {
+        if (stackTrace)
+            status = run<true, true, true>(budget);
+        else
+            status = run<true, false, true>(budget);
+    } else if (verified) {
+        if (stackTrace)
+            status = run<false, true, false>(budget);
+        else
+            status = run<false, false, false>(budget);
+    } else {
+        if (stackTrace)
+            status = run<false, true, true>(budget);
+        else
+            status = run<false, false, true>(budget);
+    }
+    executeSeconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return status;
 }
 
 static std::vector<std::string> mniCallStackInternal;
@@ -1796,6 +3246,31 @@ void Interpreter::callMNI(const std::string &name,
     mniCallStackInternal.pop_back();
 }
 
+int parseRamSize(const std::string &text) {
+    size_t end = 0;
+    unsigned long long size = 0;
+    try {
+        size = std::stoull(text, &end);
+    } catch (const std::exception &) {
+        end = 0;
+    }
+    if (end == 0 || text[0] == '-')
+        throw std::runtime_error("Invalid RAM size: " + text);
+    std::string suffix = text.substr(end);
+    int shift = suffix.empty() ? 0
+                : suffix == "K" || suffix == "k" ? 10
+                : suffix == "M" || suffix == "m" ? 20
+                : suffix == "G" || suffix == "g" ? 30
+                : -1;
+    if (shift < 0)
+        throw std::runtime_error("Invalid RAM size suffix (use K, M or G): " +
+                                 text);
+    if (size == 0 ||
+        size > (unsigned long long)std::numeric_limits<int>::max() >> shift)
+        throw std::runtime_error("RAM size out of range: " + text);
+    return (int)(size << shift);
+}
+
 // --- Standalone Interpreter Main Function Definition ---
 
 int microasm_interpreter_main(int argc, char *argv[]) {
@@ -1803,6 +3278,9 @@ int microasm_interpreter_main(int argc, char *argv[]) {
     std::string bytecodeFile;
     bool enableDebug = false;
     bool stackTrace = false;
+    bool printStats = false;
+    bool enableJit = false;
+    int ramSize = MEMORY_SIZE;
     std::vector<std::string> programArgs; // Args for the interpreted program
 
     // argv[0] here is the *first argument* after "-i", not the program name
@@ -1812,6 +3290,30 @@ int microasm_interpreter_main(int argc, char *argv[]) {
             enableDebug = true;
         } else if (arg == "-t" || arg == "--trace") {
             stackTrace = true;
+        } else if (arg == "-s" || arg == "--stats") {
+            printStats = true;
+        } else if (arg == "-j" || arg == "--jit") {
+            enableJit = true;
+        } else if (arg.rfind("--vector-isa=", 0) == 0) {
+            // Older kernels than the CPU supports, to test or compare them
+            std::string isa = arg.substr(13);
+            if (isa == "scalar") {
+                setVectorIsa(VectorIsa::SCALAR);
+            } else if (isa == "sse2") {
+                setVectorIsa(VectorIsa::SSE2);
+            } else if (isa == "avx2") {
+                setVectorIsa(VectorIsa::AVX2);
+            } else {
+                std::cerr << "Unknown vector ISA: " << isa << " (expected scalar, sse2 or avx2)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--ram" && i + 1 < argc) {
+            try {
+                ramSize = parseRamSize(argv[++i]);
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
         } else if (bytecodeFile.empty()) {
             bytecodeFile = arg;
         } else {
@@ -1821,7 +3323,7 @@ int microasm_interpreter_main(int argc, char *argv[]) {
     }
 
     if (bytecodeFile.empty()) {
-        std::cerr << "Interpreter Usage: <bytecode.bin> [args...] [-d|--debug]"
+        std::cerr << "Interpreter Usage: <bytecode.bin> [args...] [-d|--debug] [-t|--trace] [-s|--stats] [-j|--jit] [--ram <size>] [--vector-isa=scalar|sse2|avx2]"
                   << std::endl;
         return 1;
     }
@@ -1829,10 +3331,15 @@ int microasm_interpreter_main(int argc, char *argv[]) {
     // --- End Argument Parsing ---
 
     try {
-        Interpreter interpreter(65536, programArgs, enableDebug,
+        Interpreter interpreter(ramSize, programArgs, enableDebug,
                                 stackTrace); // Pass debug flag
+        interpreter.setJitEnabled(enableJit);
         interpreter.load(bytecodeFile);
         interpreter.execute();
+        if (printStats)
+            interpreter.printStats(std::cerr);
+        else if (enableJit)
+            interpreter.printTiering(std::cerr);
 
         std::cout << "Execution finished successfully!"
                   << std::endl; // HLT used to provide its own message
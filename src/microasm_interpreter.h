@@ -1,14 +1,21 @@
 #ifndef MICROASM_INTERPRETER_H
 #define MICROASM_INTERPRETER_H
 
+#include <array>
 #include <string>
 #include <vector>
 #include <stack>
 #include <map>
+#include <memory>
 #include <functional>
+#include <ostream>
 #include <cstdint> // Required for uint8_t
+#include <cstring>
 #include "common_defs.h"   // Include common definitions (Opcode, BinaryHeader)
 #include "operand_types.h" // Include operand types
+#include "microasm_jit.h"
+#include "microasm_ram.h"
+#include "heap.h"
 
 // Structure to hold operand info read from bytecode
 struct BytecodeOperand {
@@ -17,6 +24,25 @@ struct BytecodeOperand {
     bool use_reg = false; // used only for math_operator.
 };
 
+// Zero bytes load() appends to the code segment, so an operand value can
+// always be fetched with a single 8 byte load.
+constexpr size_t BYTECODE_PADDING = 8;
+
+// Value of a `size` byte operand at p. Reads 8 bytes in one unaligned load
+// (little-endian, like the rest of the loader) and keeps `size` of them, so p
+// must be followed by BYTECODE_PADDING readable bytes. 4 byte values are
+// sign-extended ints, narrower ones zero-extended, as nextRawOperand() always
+// decoded them.
+inline long long readOperandValue(const uint8_t *p, int size) {
+    static constexpr uint64_t widthMask[16] = {
+        0, 0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF, 0xFFFFFFFFFFull, 0xFFFFFFFFFFFFull,
+        0xFFFFFFFFFFFFFFull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull};
+    uint64_t raw;
+    std::memcpy(&raw, p, sizeof raw);
+    raw &= widthMask[size & 15];
+    return size == 4 ? (long long)(int32_t)raw : (long long)raw;
+}
+
 // Forward declaration
 class Interpreter;
 
@@ -29,52 +55,301 @@ extern std::map<std::string, MniFunctionType> mniRegistry;
 // Declare the function to register MNI functions
 void registerMNI(const std::string& module, const std::string& name, MniFunctionType func);
 
+// Opcodes that get operand-kind specialized handlers
+#define MASM_FOR_EACH_SPECIALIZED_OPCODE(X)                                    \
+    X(MOV) X(ADD) X(SUB) X(MUL) X(AND) X(OR) X(XOR) X(SHL) X(SHR) X(CMP)
+
+// Internal handler ids the execute loop dispatches on in addition to the
+// regular opcodes. These never appear in bytecode.
+enum InternalOp : uint8_t {
+    OP_DECODE_FAULT = 0x80, // Operands could not be decoded, raise decodeError
+    OP_JIT_BLOCK,           // Run the native code in jitBlocks for this index
+    OP_HOT_COUNTER,         // Tier-up candidate, counts executions in hotCounters
+
+    // Superinstructions chosen by fuseSuperinstructions(). Each one sits on the
+    // first instruction of its sequence; the following instructions keep their
+    // own entries so jumping into the middle of a sequence still works.
+    OP_CMP_JCC,       // CMP a b; Jcc #label
+    OP_INC_CMP_JCC,   // INC reg; CMP reg/imm reg/imm; Jcc #label
+    OP_PUSH_FRAME,    // PUSH RBP; MOV RBP RSP
+    OP_LEAVE_RET,     // LEAVE; RET
+    OP_POP_FRAME_RET, // MOV RSP RBP; POP RBP; RET
+    OP_FUSED_END,
+
+    // Operand-kind specialized forms of the common two-operand instructions,
+    // chosen by specializedHandler() when the destination is a register and
+    // the source a register or immediate, e.g. OP_ADD_REG_IMM runs
+    // ADD<REGISTER, IMMEDIATE> without going through getValue/writeToOperand.
+#define MASM_SPECIALIZED_OPCODE(name) OP_##name##_REG_REG, OP_##name##_REG_IMM,
+    MASM_FOR_EACH_SPECIALIZED_OPCODE(MASM_SPECIALIZED_OPCODE)
+#undef MASM_SPECIALIZED_OPCODE
+    // LOOP on a register and CJcc with a register on the left, both with a
+    // resolved target
+    OP_LOOP_REG, OP_CJCC_REG_REG, OP_CJCC_REG_IMM,
+    OP_SPECIALIZED_END
+};
+
+constexpr int OP_FUSED_FIRST = OP_CMP_JCC;
+constexpr int OP_FUSED_COUNT = OP_FUSED_END - OP_FUSED_FIRST;
+
+// Executions of a CALL or backward-jump target before it is compiled
+constexpr uint32_t JIT_HOT_THRESHOLD = 100;
+
+// Size of the register file: RAX, RBX, RCX, RDX, RSI, RDI, RBP, RSP, R0-R15.
+// MasmRegisters in microasm_capi.h has the same layout.
+constexpr int REGISTER_COUNT = 24;
+
+// Bytes allocated after RAM when it is addressed through a mask (the
+// MASM_MASKED_RAM build), so a multi-byte access at the last masked address
+// stays inside the buffer.
+constexpr int RAM_GUARD_SIZE = 8;
+
+// Why execution stopped. The execute loop and its helpers record one of these
+// (plus a value for the message) instead of throwing; the message is only
+// built once the loop has left, see Interpreter::faultMessage().
+enum class Fault : uint8_t {
+    NONE,
+    MEMORY_READ,       // faultValue: address
+    MEMORY_WRITE,      // faultValue: address
+    INVALID_REGISTER,  // faultValue: register index
+    NOT_A_REGISTER,    // faultValue: operand type
+    NO_RAM_ADDRESS,    // Register or immediate used as a memory operand
+    BAD_OPERAND_TYPE,  // faultValue: operand type
+    BAD_MATH_OPERATOR,
+    BAD_JUMP_TARGET,   // faultValue: code offset
+    MEMORY_BOUNDS,     // Masked RAM: some access since the last check was out of range
+    STACK_UNDERFLOW,
+    DIVISION_BY_ZERO,
+    MESSAGE            // Anything else, the text is in faultText
+};
+
+// How Interpreter::execute(budget) returned
+enum class ExecutionStatus : uint8_t {
+    HALTED,   // HLT or the end of the program was reached
+    SUSPENDED // The budget ran out; execute() again continues from there
+};
+
+// One instruction decoded from bytecode_raw at load time, so the hot loop never
+// has to re-parse operand type bytes.
+struct DecodedInstruction {
+    uint8_t opcode = 0;       // Opcode as stored in the bytecode
+    uint8_t op = 0;           // Handler the execute loop dispatches on
+    uint8_t operandCount = 0;
+    int offset = 0;           // Byte offset of the opcode in the code segment
+    int next = 0;             // Byte offset of the following instruction
+    int target = -1;          // Resolved jump target index, mniCalls slot for MNI, jumpTables slot for JMPTAB
+    BytecodeOperand operands[3];
+};
+
+// A JMPTAB table as the DT directive lays it out in RAM: an int32 entry
+// count followed by that many int32 code offsets. It is read once at load.
+struct DecodedJumpTable {
+    int address = 0;
+    std::vector<int> offsets; // Entries as stored
+    std::vector<int> targets; // Entries as program indices, -1 if not an instruction boundary
+};
+
+// MNI calls carry a variable number of arguments so they live out of line.
+struct DecodedMni {
+    std::string name;
+    std::vector<BytecodeOperand> args;
+    const MniFunctionType *function = nullptr; // Entry in mniRegistry, resolved by load()
+};
+
+// Everything load() decodes from the code segment. It does not change after
+// load(), so clones share it instead of copying it.
+struct LoadedProgram {
+    std::vector<DecodedInstruction> program;
+    std::vector<uint8_t> fast;      // Per program index, handler for the release loop: a superinstruction, a specialized handler or op
+    std::vector<int> offsetToIndex; // code offset -> program index, -1 if not a boundary
+    std::vector<DecodedMni> mniCalls;
+    std::vector<DecodedJumpTable> jumpTables;
+};
+
 struct stack_frame {
     uint32_t rbp;
     uint32_t ip;
 };
 
+// A member a copied Interpreter starts over with instead of copying, so the
+// copy constructor can stay the compiler's. clone() sets up the ones it needs.
+template <typename T>
+struct NotCopied : T {
+    using T::T;
+    using T::operator=;
+    NotCopied() = default;
+    NotCopied(const NotCopied &) : T() {}
+};
+
 class Interpreter {
 public: // Public members needed by C API or main
-    std::vector<int> registers; // [0]=RAX, [1]=RBX, ..., [6]=RBP, [7]=RSP, [8]=R0, ..., [23]=R15
-    std::vector<char> ram;      // Make public for direct access from C API wrapper
+    // [0]=RAX, [1]=RBX, ..., [6]=RBP, [7]=RSP, [8]=R0, ..., [23]=R15. RSP and
+    // RBP are the stack and base pointer, there is no separate copy. Programs
+    // without 64-bit registers keep sign-extended 32-bit values here, see
+    // toRegister().
+    alignas(64) std::array<int64_t, REGISTER_COUNT> registers{};
+    NotCopied<Ram> ram;         // Make public for direct access from C API wrapper. With masked RAM this includes the guard area.
 
 private: // Private members
+    // Code segment plus BYTECODE_PADDING zero bytes, only kept while load()
+    // decodes it
     std::vector<uint8_t> bytecode_raw;
+    size_t codeSize = 0;                    // Code segment size, without the padding
+    std::shared_ptr<const LoadedProgram> loaded; // bytecode_raw decoded, shared with clones
+    std::string decodeError;
+    // Set by load() when verifyProgram() accepted the program, which lets the
+    // release loop drop the operand checks the verifier already made.
+    bool verified = false;
+    std::string verifyError; // Why verification failed
     int ip = 0;
-    int sp;
-    int bp;
+    // Condition flags are evaluated lazily: CMP only records its operands and
+    // ZF/SF are derived when a conditional jump or getZeroFlag()/getSignFlag()
+    // asks. Flags set directly (MNI functions, compiled blocks) are kept as
+    // values.
+    enum class FlagKind : uint8_t { COMPARE, VALUES };
+    int64_t flagLhs = 1;                   // COMPARE: left operand, VALUES: ZF
+    int64_t flagRhs = 0;                   // COMPARE: right operand, VALUES: SF
+    FlagKind flagKind = FlagKind::COMPARE; // 1 vs 0: ZF=0, SF=0
+    size_t ramBytes = 0;         // Usable RAM, ram.size() without the guard area
+    uint32_t ramMask = 0;        // ramBytes - 1 with masked RAM
+    uint64_t ramOutOfBounds = 0; // Masked RAM: non-zero once an access was out of range
+    NotCopied<Heap> heap;        // MALLOC/FREE, over the RAM below the stack
+    // Set by load() for version 3 binaries with BINARY_FLAG_WIDE_REGISTERS:
+    // registers and arithmetic are 64-bit, and so are register values in RAM
+    // (MOV to memory, MOVADDR/MOVTO, stack slots).
+    bool wideRegisters = false;
+    int wordSize = 4; // Bytes of a register value in RAM
+    int shiftMask = 31; // SHL/SHR use the count modulo the register width
 
     std::vector<std::string> cmdArgs;
     bool debugMode = false;
     bool stackTrace = false;
+    uint64_t instructionsExecuted = 0;
+    bool suspended = false; // The last execute() ran out of budget
+
+    // Pending fault, set by the non-throwing helpers below
+    Fault fault = Fault::NONE;
+    long long faultValue = 0;
+    std::string faultText;
+    // The fault that stopped the last execute() and where it happened
+    Fault trapCode = Fault::NONE;
+    int trapIp = -1;
+    uint64_t fusionHits[OP_FUSED_COUNT] = {}; // Executions of each superinstruction
+    bool jitEnabled = false;
+    NotCopied<Jit> jit;
+    NotCopied<std::vector<JitBlock>> jitBlocks; // Compiled block per program index, or nullptr
+    uint64_t jitEntries = 0;
+
+    // Tiered execution: CALL and backward-jump targets start out interpreted
+    // and are handed to the JIT once they have run JIT_HOT_THRESHOLD times.
+    // fastHandlers is loaded->fast with OP_HOT_COUNTER on those targets and
+    // OP_JIT_BLOCK on the compiled ones.
+    NotCopied<std::vector<uint8_t>> fastHandlers;  // Per program index
+    NotCopied<std::vector<uint32_t>> hotCounts;    // Executions per program index
+    NotCopied<std::vector<int>> tierUps;           // Offsets of promoted blocks, in order
+    double executeSeconds = 0;
+    double nativeSeconds = 0;
+    double compileSeconds = 0;
+
+    // Copies everything but RAM, the heap and the JIT state, see clone()
+    Interpreter(const Interpreter &) = default;
 
     // Private methods
+    void initHeap(size_t base);
     BytecodeOperand nextRawOperand();
+    void decodeProgram();
+    int decodeJumpTable(LoadedProgram &image, const BytecodeOperand &op);
+    std::string verifyProgram() const;
+    void fuseSuperinstructions(LoadedProgram &image);
+    void prepareTiering();
+    uint8_t promoteBlock(size_t index);
+    template <uint8_t Op, OperandType Src> void executeSpecialized(const DecodedInstruction &in);
+    size_t instructionIndex(int offset);
     int getRegisterIndex(const BytecodeOperand& operand);
-    void pushStack(int value);
-    int popStack();
+    void pushStack(int64_t value);
+    int64_t popStack();
+
+    // Non-throwing counterparts of the helpers used by the execute loop. On
+    // failure they record a fault (see setFault) and return 0.
+    void setFault(Fault code, long long value = 0);
+    std::string faultMessage() const;
+    [[noreturn]] void raiseFault();
+    // Checked = false skips the register range checks for verified programs.
+    template <bool Checked = true> int64_t loadValue(const BytecodeOperand& operand, int size);
+    template <bool Checked = true> int registerIndex(const BytecodeOperand& operand); // -1 on fault
+    int mathOperatorAddr(const BytecodeOperand& operand);
+    int loadRamInt(int address);
+    void storeRamInt(int address, int value);
+    int64_t loadRamNum(int address, int size);
+    void storeRamNum(int address, int64_t value, int size);
+    char loadRamChar(int address);
+    std::string loadRamString(int address);
+    void stackPush(int64_t value);
+    int64_t stackPop();
+    void setCompare(int64_t lhs, int64_t rhs) {
+        flagLhs = lhs;
+        flagRhs = rhs;
+        flagKind = FlagKind::COMPARE;
+    }
+    bool conditionHolds(uint8_t opcode) const;
+    char *maskedRam(int address, int width);
+    void collectRamFault();
+    void reportFault(bool trace, int currentIp, Opcode opcode, const std::string& message);
     std::string readBytecodeString();
     void initializeMNIFunctions();
     std::string formatOperandDebug(const BytecodeOperand& op);
-    int getOperandSize(char type);
-    void writeToOperand(BytecodeOperand op, int val, int size);
-    int getRamAddr(BytecodeOperand op);
+    int getOperandSize(uint8_t type);
+    template <bool Checked = true> void writeToOperand(const BytecodeOperand& op, int64_t val, int size);
+    int getRamAddr(const BytecodeOperand& op);
     void debugger(bool end=false);
     void debugger_init();
+    // The execute loop, instantiated once per debug/trace combination so the
+    // release build carries no debug checks. Checked = false is the release
+    // loop for verified programs.
+    template <bool Debug, bool Trace, bool Checked> ExecutionStatus run(uint64_t budget);
+    void debugBeforeInstruction(Opcode opcode, std::vector<int64_t>& regsBefore);
+    void debugAfterInstruction(const std::vector<int64_t>& regsBefore);
 
 public: // Public methods including memory access for C API
     // Constructor
 
     void callMNI(const std::string& name, const std::vector<BytecodeOperand>& args);
     Interpreter(int ramSize = 65536, const std::vector<std::string>& args = {}, bool debug = false, bool trace = false);
-    bool zeroFlag = false;
-    bool signFlag = false;
+    Interpreter &operator=(const Interpreter &) = delete;
+
+    // A new interpreter in the same state as this one, usually called once
+    // after load() to stamp out instances without reading the file again.
+    // The clone shares the decoded program and its RAM is a copy-on-write
+    // view of this one's, so only pages either side writes get copied. It starts
+    // without native blocks and tiers up on its own. Must not run while this
+    // interpreter executes, but several threads may clone it at once.
+    std::unique_ptr<Interpreter> clone();
+    // Condition flags as left by the last comparison
+    bool getZeroFlag() const {
+        return flagKind == FlagKind::COMPARE ? flagLhs == flagRhs : flagLhs != 0;
+    }
+    bool getSignFlag() const {
+        return flagKind == FlagKind::COMPARE ? flagLhs < flagRhs : flagRhs != 0;
+    }
+    void setFlags(bool zero, bool sign) {
+        flagLhs = zero;
+        flagRhs = sign;
+        flagKind = FlagKind::VALUES;
+    }
+    void setZeroFlag(bool zero) { setFlags(zero, getSignFlag()); }
+    // Whether the loaded program has 64-bit registers (bytecode version 3)
+    bool hasWideRegisters() const { return wideRegisters; }
+    // `value` as a register of this program holds it: unchanged with 64-bit
+    // registers, else truncated to 32 bits and sign-extended. Code that
+    // writes `registers` directly should store this.
+    int64_t toRegister(int64_t value) const {
+        return wideRegisters ? value : (int64_t)(int32_t)value;
+    }
     // Memory access helpers (already public)
     int readRamInt(int address);
     void writeRamInt(int address, int value);
-    int readRamNum(int address, int size);
-    void writeRamNum(int address, int value, int size);
+    int64_t readRamNum(int address, int size);
+    void writeRamNum(int address, int64_t value, int size);
     char readRamChar(int address);
     void writeRamChar(int address, char value);
     std::string readRamString(int address);
@@ -83,8 +358,14 @@ public: // Public methods including memory access for C API
     void load(const std::string& bytecodeFile);
     void execute();
 
+    // Run for about `budget` instructions. The budget is checked where control
+    // leaves a basic block, so a run can retire a few more. Returns SUSPENDED
+    // when it ran out; the next execute() call then continues where this one
+    // stopped. Faults throw as with execute().
+    ExecutionStatus execute(uint64_t budget);
+
     // Public helper needed by MNI and internal logic (already public)
-    int getValue(const BytecodeOperand& operand, int size);
+    int64_t getValue(const BytecodeOperand& operand, int size);
     int getAdvancedAddr(const BytecodeOperand operand);
     
     // Add a way to set arguments after construction (needed for C API)
@@ -93,13 +374,44 @@ public: // Public methods including memory access for C API
     // Allow C API to enable/disable debug mode if needed post-creation
     void setDebugMode(bool enabled);
 
+    // Run basic blocks as native code where the platform supports it. The
+    // debugger always interprets.
+    void setJitEnabled(bool enabled);
+
+    // Whether the loaded program passed the load-time verifier, and if not why
+    bool isVerified() const { return verified; }
+    const std::string& getVerifyError() const { return verifyError; }
+
+    // Usable RAM in bytes. With masked RAM this is the configured size rounded
+    // up to a power of two.
+    size_t getRamSize() const { return ramBytes; }
+
     // Get the current instruction pointer
     int getIP() const { return ip; }
 
+    // Why the last execute() stopped with an error, and the offset of the
+    // faulting instruction. Fault::NONE and -1 after a clean run.
+    Fault getTrapCode() const { return trapCode; }
+    int getTrapIP() const { return trapIp; }
+
+    // Number of instructions retired since the program was started, over all
+    // execute() calls that continued it
+    uint64_t getInstructionCount() const { return instructionsExecuted; }
+
+    // Print the instruction count and how often each superinstruction fired
+    void printStats(std::ostream& out) const;
+
+    // Print the blocks promoted to native code and the time spent per tier
+    void printTiering(std::ostream& out) const;
+
     // Execute a single instruction (must be implemented)
     void executeStep();
 };
 
+// RAM size from a --ram argument: bytes, or a number with a K, M or G suffix.
+// Throws std::runtime_error for anything else or sizes that do not fit an int.
+int parseRamSize(const std::string& text);
+
 // Declare the standalone main function for the interpreter
 int microasm_interpreter_main(int argc, char* argv[]);
 
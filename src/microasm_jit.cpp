@@ -0,0 +1,352 @@
+// Masm baseline JIT, see microasm_jit.h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include "microasm_jit.h"
+#include "microasm_interpreter.h"
+
+// Native code generation needs an x86-64 Linux host; everywhere else every
+// block stays in the interpreter.
+#if defined(MASM_JIT) && defined(__x86_64__) && defined(__linux__)
+#define MASM_USE_JIT 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define MASM_USE_JIT 0
+#endif
+
+#if MASM_USE_JIT
+namespace {
+
+// Host registers used by the generated code. RDI holds the JitContext and
+// RSI the guest register file for the whole block.
+enum HostReg : uint8_t { EAX = 0, ECX = 1, EDX = 2, RSI = 6, RDI = 7 };
+
+// x86 condition codes for Jcc/SETcc
+enum Cond : uint8_t { CC_B = 0x2, CC_E = 0x4, CC_NE = 0x5, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+constexpr uint8_t modrm(uint8_t mod, uint8_t reg, uint8_t rm) {
+    return (mod << 6) | (reg << 3) | rm;
+}
+
+bool isRegister(const BytecodeOperand &op) {
+    return op.type == OperandType::REGISTER && op.value >= 0 && op.value < 24;
+}
+
+// Straight-line instructions with a native translation. These are exactly
+// the forms the interpreter has operand-kind specialized handlers for, plus
+// INC and NOT on a register, none of which can fault.
+bool translatable(const DecodedInstruction &in) {
+    switch (in.op) {
+        case MOV: case ADD: case SUB: case MUL: case AND: case OR: case XOR:
+        case SHL: case SHR: case CMP:
+            return in.operandCount == 2 && isRegister(in.operands[0]) &&
+                   (isRegister(in.operands[1]) ||
+                    in.operands[1].type == OperandType::IMMEDIATE);
+        case INC: case NOT:
+            return in.operandCount == 1 && isRegister(in.operands[0]);
+        default:
+            return false;
+    }
+}
+
+// JMP, a conditional jump, LOOP on a register or CJcc of a register with a
+// register/immediate whose target was resolved at load time
+bool isResolvedBranch(const DecodedInstruction &in) {
+    int index = 0;
+    switch (in.op) {
+        case JMP: case JE: case JNE: case JL: case JG: case JLE: case JGE:
+            break;
+        case LOOP:
+            if (!isRegister(in.operands[0]))
+                return false;
+            index = 1;
+            break;
+        case CJE: case CJNE: case CJL: case CJG: case CJLE: case CJGE:
+            if (!isRegister(in.operands[0]) ||
+                (!isRegister(in.operands[1]) &&
+                 in.operands[1].type != OperandType::IMMEDIATE))
+                return false;
+            index = 2;
+            break;
+        default:
+            return false;
+    }
+    return in.target >= 0 &&
+           (in.operands[index].type == OperandType::LABEL_ADDRESS ||
+            in.operands[index].type == OperandType::IMMEDIATE);
+}
+
+// Signed host condition of a guest comparison
+Cond compareCondition(uint8_t op) {
+    switch (op) {
+        case JE: case CJE: return CC_E;
+        case JNE: case CJNE: return CC_NE;
+        case JL: case CJL: return CC_L;
+        case JG: case CJG: return CC_G;
+        case JLE: case CJLE: return CC_LE;
+        default: return CC_GE;
+    }
+}
+
+class Assembler {
+    std::vector<uint8_t> code;
+    bool wide;              // 64-bit guest registers, else 32-bit arithmetic
+    bool flagsLive = false; // Host flags hold the result of the last guest CMP
+
+    void emit(std::initializer_list<uint8_t> bytes) {
+        code.insert(code.end(), bytes);
+    }
+    void emit32(uint32_t value) {
+        for (int i = 0; i < 4; i++)
+            code.push_back((value >> (8 * i)) & 0xFF);
+    }
+    void rexW() { // Operand size prefix of 64-bit guest operations
+        if (wide)
+            emit({0x48});
+    }
+    void loadRegister(HostReg host, int guest) { // mov host, [rsi + 8*guest]
+        rexW();
+        emit({0x8B, modrm(2, host, RSI)});
+        emit32(guest * 8);
+    }
+    // mov [rsi + 8*guest], host; a 32-bit result is sign-extended first
+    void storeRegister(int guest, HostReg host) {
+        if (!wide)
+            emit({0x48, 0x63, modrm(3, host, host)}); // movsxd host, host32
+        emit({0x48, 0x89, modrm(2, host, RSI)});
+        emit32(guest * 8);
+    }
+    void loadSource(const BytecodeOperand &op) { // ecx <- register or immediate
+        if (op.type == OperandType::REGISTER) {
+            loadRegister(ECX, op.value);
+        } else if (!wide || op.value == (int32_t)op.value) {
+            rexW(); // mov rcx, simm32 when wide
+            emit({0xC7, modrm(3, 0, ECX)});
+            emit32((uint32_t)(int)op.value);
+        } else {
+            emit({0x48, 0xB8 + ECX}); // mov rcx, imm64
+            emit32((uint32_t)op.value);
+            emit32((uint32_t)((uint64_t)op.value >> 32));
+        }
+    }
+    void contextByte(std::initializer_list<uint8_t> opcode, HostReg reg, size_t field) {
+        emit(opcode);
+        emit({modrm(2, reg, RDI)});
+        emit32(field);
+    }
+
+public:
+    explicit Assembler(bool wide) : wide(wide) {}
+
+    size_t size() const { return code.size(); }
+    const uint8_t *data() const { return code.data(); }
+
+    void prologue() { // mov rsi, [rdi + registers]
+        emit({0x48, 0x8B, modrm(2, RSI, RDI)});
+        emit32(offsetof(JitContext, registers));
+    }
+
+    void instruction(const DecodedInstruction &in) {
+        int dest = in.operands[0].value;
+        flagsLive = false;
+        switch (in.op) {
+            case MOV:
+                loadSource(in.operands[1]);
+                storeRegister(dest, ECX);
+                return;
+            case INC:
+                loadRegister(EAX, dest);
+                rexW();
+                emit({0x83, modrm(3, 0, EAX), 0x01}); // add eax, 1
+                storeRegister(dest, EAX);
+                return;
+            case NOT:
+                loadRegister(EAX, dest);
+                rexW();
+                emit({0xF7, modrm(3, 2, EAX)}); // not eax
+                storeRegister(dest, EAX);
+                return;
+            default:
+                break;
+        }
+
+        loadSource(in.operands[1]);
+        loadRegister(EAX, dest);
+        rexW();
+        switch (in.op) {
+            case ADD: emit({0x01, modrm(3, ECX, EAX)}); break; // add eax, ecx
+            case SUB: emit({0x29, modrm(3, ECX, EAX)}); break;
+            case AND: emit({0x21, modrm(3, ECX, EAX)}); break;
+            case OR:  emit({0x09, modrm(3, ECX, EAX)}); break;
+            case XOR: emit({0x31, modrm(3, ECX, EAX)}); break;
+            case MUL: emit({0x0F, 0xAF, modrm(3, EAX, ECX)}); break; // imul eax, ecx
+            case SHL: emit({0xD3, modrm(3, 4, EAX)}); break;         // shl eax, cl
+            case SHR: emit({0xD3, modrm(3, 7, EAX)}); break;         // sar eax, cl
+            case CMP:
+                emit({0x39, modrm(3, ECX, EAX)}); // cmp eax, ecx
+                contextByte({0x0F, 0x90 + CC_E}, EAX, offsetof(JitContext, zeroFlag));
+                contextByte({0x0F, 0x90 + CC_L}, EAX, offsetof(JitContext, signFlag));
+                flagsLive = true;
+                return;
+        }
+        storeRegister(dest, EAX);
+    }
+
+    // Jump if the guest branch `in` is taken; returns the rel32 to patch.
+    size_t branch(const DecodedInstruction &in) {
+        uint8_t op = in.op;
+        Cond cc;
+        if (op == LOOP) {
+            int counter = in.operands[0].value;
+            loadRegister(EAX, counter);
+            rexW();
+            emit({0x83, modrm(3, 5, EAX), 0x01}); // sub eax, 1
+            storeRegister(counter, EAX);         // Leaves the flags alone
+            cc = CC_NE;
+        } else if (op != JE && op != JNE && op != JL && op != JG && op != JLE &&
+                   op != JGE) {
+            // CJcc: compare without touching the guest flags
+            loadSource(in.operands[1]);
+            loadRegister(EAX, in.operands[0].value);
+            rexW();
+            emit({0x39, modrm(3, ECX, EAX)}); // cmp eax, ecx
+            cc = compareCondition(op);
+        } else if (flagsLive) {
+            // Straight after a CMP: SF is "less than", so the signed host
+            // conditions give the same answers as conditionMet().
+            cc = compareCondition(op);
+        } else {
+            // Flags from an earlier block: evaluate conditionMet() on the
+            // stored values, eax = ZF and edx = SF.
+            contextByte({0x0F, 0xB6}, EAX, offsetof(JitContext, zeroFlag));
+            contextByte({0x0F, 0xB6}, EDX, offsetof(JitContext, signFlag));
+            switch (op) {
+                case JE:
+                    emit({0x85, modrm(3, EAX, EAX)}); cc = CC_NE; break;
+                case JNE:
+                    emit({0x85, modrm(3, EAX, EAX)}); cc = CC_E; break;
+                case JL:
+                    emit({0x85, modrm(3, EDX, EDX)}); cc = CC_NE; break;
+                case JG:
+                    emit({0x09, modrm(3, EDX, EAX)}); cc = CC_E; break;
+                case JLE:
+                    emit({0x09, modrm(3, EDX, EAX)}); cc = CC_NE; break;
+                default: // JGE: ZF || !SF
+                    emit({0x83, modrm(3, 6, EDX), 0x01});
+                    emit({0x09, modrm(3, EDX, EAX)});
+                    cc = CC_NE;
+                    break;
+            }
+        }
+        emit({0x0F, (uint8_t)(0x80 + cc)});
+        emit32(0);
+        return code.size() - 4;
+    }
+
+    void bind(size_t rel32, size_t target) {
+        uint32_t rel = (uint32_t)(target - (rel32 + 4));
+        std::memcpy(&code[rel32], &rel, 4);
+    }
+
+    // Count `retired` instructions and return `next` to the interpreter
+    void exit(uint32_t retired, uint32_t next) {
+        countRetired(retired);
+        emit({0xB8 + EAX});
+        emit32(next);
+        emit({0xC3});
+    }
+
+    // Jump back to `head` while the block is within its budget, otherwise
+    // return `start` so the interpreter can suspend at the loop head.
+    void loopBack(size_t head, uint32_t start) {
+        emit({0x48, 0x8B, modrm(2, EAX, RDI)}); // mov rax, [rdi + budget]
+        emit32(offsetof(JitContext, budget));
+        emit({0x48, 0x39, modrm(2, EAX, RDI)}); // cmp [rdi + executed], rax
+        emit32(offsetof(JitContext, executed));
+        emit({0x0F, 0x80 + CC_B});              // jb head
+        emit32(0);
+        bind(code.size() - 4, head);
+        emit({0xB8 + EAX});
+        emit32(start);
+        emit({0xC3});
+    }
+
+    void countRetired(uint32_t retired) { // add qword [rdi + executed], retired
+        emit({0x48, 0x81, modrm(2, 0, RDI)});
+        emit32(offsetof(JitContext, executed));
+        emit32(retired);
+    }
+};
+
+} // namespace
+#endif
+
+Jit::~Jit() {
+#if MASM_USE_JIT
+    for (auto &region : regions)
+        munmap(region.first, region.second);
+#endif
+}
+
+bool Jit::supported() {
+    return MASM_USE_JIT;
+}
+
+JitBlock Jit::compile(const std::vector<DecodedInstruction> &program, size_t start,
+                      bool wide) {
+#if MASM_USE_JIT
+    Assembler a(wide);
+    a.prologue();
+    size_t head = a.size();
+
+    size_t i = start;
+    while (i < program.size() && translatable(program[i]))
+        a.instruction(program[i++]);
+
+    size_t covered = i - start;
+    if (i < program.size() && isResolvedBranch(program[i])) {
+        const DecodedInstruction &in = program[i];
+        covered++;
+        if (in.op != JMP) {
+            size_t taken = a.branch(in);
+            a.exit(covered, i + 1); // Not taken: fall through
+            a.bind(taken, a.size());
+        }
+        if ((size_t)in.target == start) {
+            // Loops back to this block: stay in native code
+            a.countRetired(covered);
+            a.loopBack(head, start);
+        } else {
+            a.exit(covered, in.target);
+        }
+    } else {
+        a.exit(covered, i);
+    }
+    // A single instruction does not pay for the call into native code
+    if (covered < 2)
+        return nullptr;
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t length = (a.size() + page - 1) / page * page;
+    void *memory = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+    std::memcpy(memory, a.data(), a.size());
+    if (mprotect(memory, length, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, length);
+        return nullptr;
+    }
+    regions.push_back({memory, length});
+    return reinterpret_cast<JitBlock>(memory);
+#else
+    (void)program;
+    (void)start;
+    (void)wide;
+    return nullptr;
+#endif
+}
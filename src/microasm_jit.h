@@ -0,0 +1,50 @@
+// Masm baseline JIT
+
+// Translates basic blocks of the decoded program into x86-64 code. Only
+// register/immediate arithmetic, CMP and resolved jumps are translated; a
+// block ends at the first instruction that has no translation and the
+// interpreter carries on from there.
+#ifndef MICROASM_JIT_H
+#define MICROASM_JIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct DecodedInstruction;
+
+// State shared between the interpreter and compiled blocks. Blocks address
+// the register file through `registers` and keep the flags here as 0/1.
+struct JitContext {
+    int64_t *registers = nullptr;
+    uint64_t executed = 0; // Instructions retired by the block
+    uint64_t budget = UINT64_MAX; // A native loop returns once executed reaches this
+    uint8_t zeroFlag = 0;
+    uint8_t signFlag = 0;
+};
+
+// A compiled block returns the program index to continue at.
+using JitBlock = uint64_t (*)(JitContext *);
+
+class Jit {
+    std::vector<std::pair<void *, size_t>> regions; // mmap'd code, one per block
+
+public:
+    Jit() = default;
+    Jit(const Jit &) = delete;
+    Jit &operator=(const Jit &) = delete;
+    ~Jit();
+
+    // Whether this build can generate native code at all
+    static bool supported();
+
+    // Compile the block starting at program[start], with 64-bit arithmetic
+    // when `wide` and else 32-bit results sign-extended into the registers.
+    // Returns nullptr when too little of it can be translated or executable
+    // memory is unavailable.
+    JitBlock compile(const std::vector<DecodedInstruction> &program, size_t start, bool wide);
+
+    size_t blockCount() const { return regions.size(); }
+};
+
+#endif // MICROASM_JIT_H
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "microasm_ram.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MASM_MMAP_RAM 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define MASM_MMAP_RAM 0
+#endif
+
+// Images need memfd_create, elsewhere cloneTo() copies
+#if MASM_MMAP_RAM && defined(__linux__)
+#define MASM_RAM_IMAGES 1
+#else
+#define MASM_RAM_IMAGES 0
+#endif
+
+struct RamImage {
+    int fd = -1;
+#if MASM_RAM_IMAGES
+    ~RamImage() {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+};
+
+static size_t pageSize() {
+#if MASM_MMAP_RAM
+    static const size_t page = sysconf(_SC_PAGESIZE);
+    return page;
+#else
+    return 4096;
+#endif
+}
+
+static bool allZero(const char *p, size_t n) {
+    return n == 0 || (p[0] == 0 && memcmp(p, p + 1, n - 1) == 0);
+}
+
+void Ram::release() {
+#if MASM_MMAP_RAM
+    if (isMapped) {
+        munmap(bytes, length);
+        bytes = nullptr;
+    }
+#endif
+    free(bytes);
+    bytes = nullptr;
+    length = 0;
+    isMapped = false;
+    image.reset();
+    matchesImage = false;
+}
+
+void Ram::assign(size_t size) {
+    release();
+    if (size == 0)
+        return;
+#if MASM_MMAP_RAM
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map != MAP_FAILED) {
+        bytes = static_cast<char *>(map);
+        length = size;
+        isMapped = true;
+        return;
+    }
+#endif
+    bytes = static_cast<char *>(calloc(size, 1));
+    if (bytes == nullptr)
+        throw std::bad_alloc();
+    length = size;
+}
+
+#if MASM_RAM_IMAGES
+// Flags of a /proc/self/pagemap entry
+constexpr uint64_t PAGEMAP_PRESENT = 1ull << 63;
+constexpr uint64_t PAGEMAP_SWAPPED = 1ull << 62;
+constexpr uint64_t PAGEMAP_FILE = 1ull << 61; // Page of the mapped file, here the image
+
+// The pagemap entry of every page in [bytes, bytes + length). The kernel
+// answers from the page tables, so pages are neither read nor faulted in.
+static bool readPagemap(const char *bytes, size_t length, std::vector<uint64_t> &entries) {
+    int fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    entries.resize((length + pageSize() - 1) / pageSize());
+    size_t want = entries.size() * sizeof(uint64_t);
+    off_t first = reinterpret_cast<uintptr_t>(bytes) / pageSize() * sizeof(uint64_t);
+    size_t done = 0;
+    while (done < want) {
+        ssize_t n = pread(fd, reinterpret_cast<char *>(entries.data()) + done,
+                          want - done, first + done);
+        if (n <= 0)
+            break;
+        done += n;
+    }
+    close(fd);
+    return done == want;
+}
+
+// Copy the data of one image into another, leaving its holes as holes
+static bool copyImage(int from, int to, size_t length) {
+    char buffer[65536];
+    off_t data = 0;
+    while ((data = lseek(from, data, SEEK_DATA)) >= 0 && (size_t)data < length) {
+        off_t hole = lseek(from, data, SEEK_HOLE);
+        if (hole < 0)
+            return false;
+        while (data < hole) {
+            ssize_t n = pread(from, buffer, std::min<off_t>(sizeof buffer, hole - data), data);
+            if (n <= 0 || pwrite(to, buffer, n, data) != n)
+                return false;
+            data += n;
+        }
+    }
+    return data >= 0 || errno == ENXIO;
+}
+#endif
+
+// Copy the contents into a new image and map this Ram over it. Pages that
+// hold only zeros stay holes in the image. The pagemap says which pages this
+// process wrote since the last image, so only those are read, next to a copy
+// of the last image's data. Without a pagemap every page is read, which
+// faults in the ones never touched.
+bool Ram::freeze() {
+#if MASM_RAM_IMAGES
+    if (!isMapped)
+        return false;
+    auto frozen = std::make_shared<RamImage>();
+    frozen->fd = memfd_create("masm-ram", MFD_CLOEXEC);
+    if (frozen->fd < 0 || ftruncate(frozen->fd, length) != 0)
+        return false;
+    std::vector<uint64_t> pages;
+    bool tracked = readPagemap(bytes, length, pages) &&
+                   (!image || copyImage(image->fd, frozen->fd, length));
+    for (size_t i = 0, offset = 0; offset < length; i++, offset += pageSize()) {
+        // Pages never written read as zero or as the last image, copied above
+        if (tracked && (!(pages[i] & (PAGEMAP_PRESENT | PAGEMAP_SWAPPED)) ||
+                        (pages[i] & PAGEMAP_FILE)))
+            continue;
+        size_t n = std::min(pageSize(), length - offset);
+        if (!allZero(bytes + offset, n) &&
+            pwrite(frozen->fd, bytes + offset, n, offset) != (ssize_t)n)
+            return false;
+    }
+    if (mmap(bytes, length, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE, frozen->fd,
+             0) == MAP_FAILED)
+        throw std::runtime_error("Failed to map RAM over its image");
+    image = std::move(frozen);
+    matchesImage = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Ram::cloneTo(Ram &copy) {
+    std::lock_guard<std::mutex> lock(imageLock);
+    if ((image && matchesImage) || freeze()) {
+#if MASM_RAM_IMAGES
+        void *map = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_NORESERVE, image->fd, 0);
+        if (map == MAP_FAILED)
+            throw std::bad_alloc();
+        copy.release();
+        copy.bytes = static_cast<char *>(map);
+        copy.length = length;
+        copy.isMapped = true;
+        copy.image = image;
+        copy.matchesImage = true;
+        return;
+#endif
+    }
+    // No images: copy what is not zero into fresh RAM
+    copy.assign(length);
+    for (size_t offset = 0; offset < length; offset += pageSize()) {
+        size_t n = std::min(pageSize(), length - offset);
+        if (!allZero(bytes + offset, n))
+            memcpy(copy.bytes + offset, bytes + offset, n);
+    }
+}
+
+void releaseRamPages(void *addr, size_t length) {
+#if MASM_MMAP_RAM
+    const uintptr_t page = pageSize();
+    uintptr_t start = (reinterpret_cast<uintptr_t>(addr) + page - 1) & ~(page - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + length) & ~(page - 1);
+    if (end > start)
+        madvise(reinterpret_cast<void *>(start), end - start, MADV_DONTNEED);
+#else
+    (void)addr;
+    (void)length;
+#endif
+}
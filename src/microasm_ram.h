@@ -0,0 +1,68 @@
+// Masm RAM
+
+// The interpreter's RAM as one anonymous private mapping. The kernel hands
+// out zero pages the first time each page is touched, so creating RAM costs
+// the same for any size and pages a program never uses take no memory.
+// Without mmap it is a zeroed heap buffer instead.
+//
+// cloneTo() freezes the contents into an image (a memfd on Linux) and maps
+// both this Ram and the copy privately over it, so the two share every page
+// until one of them writes it. Later clones reuse the image until touch()
+// says the contents changed. Freezing reads 8 bytes of /proc/self/pagemap
+// per page of RAM and copies the pages written since the last image, so a
+// large RAM a program barely used is cheap to clone and is not faulted in.
+#ifndef MICROASM_RAM_H
+#define MICROASM_RAM_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+struct RamImage;
+
+class Ram {
+    char *bytes = nullptr;
+    size_t length = 0;
+    bool isMapped = false;
+    std::shared_ptr<RamImage> image; // Contents this Ram maps copy-on-write
+    bool matchesImage = false;       // Nothing was written since image was taken
+    std::mutex imageLock;            // Held while cloneTo() reads or takes image
+
+    void release();
+    bool freeze();
+
+public:
+    Ram() = default;
+    explicit Ram(size_t size) { assign(size); }
+    Ram(const Ram &) = delete;
+    Ram &operator=(const Ram &) = delete;
+    ~Ram() { release(); }
+
+    // Replace the contents with `size` zero bytes
+    void assign(size_t size);
+
+    // Make copy hold the same bytes as this Ram. Must not run while anything
+    // writes this Ram, but several threads may clone it at once.
+    void cloneTo(Ram &copy);
+
+    // Note that the contents may differ from the last cloneTo()
+    void touch() { matchesImage = false; }
+
+    char *data() { return bytes; }
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
+    char &operator[](size_t i) { return bytes[i]; }
+    const char &operator[](size_t i) const { return bytes[i]; }
+    char *begin() { return bytes; }
+    char *end() { return bytes + length; }
+
+    // Whether the pages can be given back with releaseRamPages()
+    bool mapped() const { return isMapped; }
+};
+
+// Give the whole pages inside [addr, addr + length) of a mapped Ram back to
+// the kernel. Their contents are lost: they read as zero, or as the image a
+// cloned Ram was mapped from, and cost memory again once written.
+void releaseRamPages(void *addr, size_t length);
+
+#endif // MICROASM_RAM_H
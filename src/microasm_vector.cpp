@@ -0,0 +1,393 @@
+// Masm vector kernels, see microasm_vector.h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "microasm_vector.h"
+
+// SSE2 is part of x86-64, AVX2 kernels are compiled with a target attribute
+// and only selected when the CPU reports it. Other hosts run the scalar
+// kernels.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MASM_USE_SIMD 1
+#include <immintrin.h>
+#define MASM_AVX2 __attribute__((target("avx2")))
+#else
+#define MASM_USE_SIMD 0
+#endif
+
+namespace {
+
+template <int W> struct Element;
+template <> struct Element<1> { using type = int8_t; using utype = uint8_t; };
+template <> struct Element<2> { using type = int16_t; using utype = uint16_t; };
+template <> struct Element<4> { using type = int32_t; using utype = uint32_t; };
+
+// RAM ranges have no alignment, so elements go through memcpy
+template <int W> typename Element<W>::type loadElement(const uint8_t *p) {
+    typename Element<W>::type value;
+    std::memcpy(&value, p, W);
+    return value;
+}
+
+template <int W> void storeElement(uint8_t *p, typename Element<W>::type value) {
+    std::memcpy(p, &value, W);
+}
+
+// Scalar kernels: the reference behaviour, and the tails of the SIMD loops
+
+template <VectorOp Op, int W> void scalarBinary(uint8_t *dest, const uint8_t *src, size_t count) {
+    using T = typename Element<W>::type;
+    using U = typename Element<W>::utype;
+    for (size_t i = 0; i < count; i++) {
+        T a = loadElement<W>(dest + i * W);
+        T b = loadElement<W>(src + i * W);
+        T result;
+        if constexpr (Op == VectorOp::ADD)
+            result = (T)(U)((U)a + (U)b);
+        else if constexpr (Op == VectorOp::SUB)
+            result = (T)(U)((U)a - (U)b);
+        else if constexpr (Op == VectorOp::MUL)
+            result = (T)(U)((uint64_t)(U)a * (U)b);
+        else if constexpr (Op == VectorOp::MIN)
+            result = a < b ? a : b;
+        else
+            result = a > b ? a : b;
+        storeElement<W>(dest + i * W, result);
+    }
+}
+
+template <int W> int64_t scalarSum(const uint8_t *src, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+        sum += (uint64_t)(int64_t)loadElement<W>(src + i * W);
+    return (int64_t)sum;
+}
+
+template <int W> int64_t scalarDot(const uint8_t *a, const uint8_t *b, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+        sum += (uint64_t)((int64_t)loadElement<W>(a + i * W) * loadElement<W>(b + i * W));
+    return (int64_t)sum;
+}
+
+#if MASM_USE_SIMD
+
+// SSE2 kernels, 16 bytes at a time. Signed 8/32-bit MIN/MAX and 32-bit
+// multiplies are SSE4.1 instructions, so they are built from SSE2 ones.
+
+template <VectorOp Op, int W> inline __m128i sse2Apply(__m128i a, __m128i b) {
+    if constexpr (Op == VectorOp::ADD) {
+        if constexpr (W == 1) return _mm_add_epi8(a, b);
+        else if constexpr (W == 2) return _mm_add_epi16(a, b);
+        else return _mm_add_epi32(a, b);
+    } else if constexpr (Op == VectorOp::SUB) {
+        if constexpr (W == 1) return _mm_sub_epi8(a, b);
+        else if constexpr (W == 2) return _mm_sub_epi16(a, b);
+        else return _mm_sub_epi32(a, b);
+    } else if constexpr (Op == VectorOp::MUL) {
+        if constexpr (W == 1) {
+            // Low bytes of the 16-bit products of the even and odd bytes
+            __m128i even = _mm_mullo_epi16(a, b);
+            __m128i odd = _mm_mullo_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+            return _mm_or_si128(_mm_and_si128(even, _mm_set1_epi16(0xFF)),
+                                _mm_slli_epi16(odd, 8));
+        } else if constexpr (W == 2) {
+            return _mm_mullo_epi16(a, b);
+        } else {
+            __m128i even = _mm_mul_epu32(a, b);
+            __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+            return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                      _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        }
+    } else if constexpr (W == 2) {
+        return Op == VectorOp::MIN ? _mm_min_epi16(a, b) : _mm_max_epi16(a, b);
+    } else {
+        __m128i greater = W == 1 ? _mm_cmpgt_epi8(a, b) : _mm_cmpgt_epi32(a, b);
+        __m128i pick = Op == VectorOp::MIN ? b : a;
+        __m128i other = Op == VectorOp::MIN ? a : b;
+        return _mm_or_si128(_mm_and_si128(greater, pick), _mm_andnot_si128(greater, other));
+    }
+}
+
+// Add the signed 32-bit lanes of v to the 64-bit lanes of acc
+inline __m128i sse2Widen(__m128i acc, __m128i v) {
+    __m128i sign = _mm_cmpgt_epi32(_mm_setzero_si128(), v);
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+    return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+}
+
+inline int64_t sse2Total(__m128i acc) {
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    return (int64_t)(lanes[0] + lanes[1]);
+}
+
+template <VectorOp Op, int W> void sse2Binary(uint8_t *dest, const uint8_t *src, size_t count) {
+    size_t bytes = count * W, i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(dest + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dest + i), sse2Apply<Op, W>(a, b));
+    }
+    scalarBinary<Op, W>(dest + i, src + i, (bytes - i) / W);
+}
+
+template <int W> int64_t sse2Sum(const uint8_t *src, size_t count) {
+    size_t bytes = count * W, i = 0;
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        if constexpr (W == 1) {
+            // Bias the bytes to unsigned and sum them with PSADBW
+            __m128i biased = _mm_xor_si128(v, _mm_set1_epi8((char)0x80));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(biased, _mm_setzero_si128()));
+        } else if constexpr (W == 2) {
+            acc = sse2Widen(acc, _mm_madd_epi16(v, _mm_set1_epi16(1)));
+        } else {
+            acc = sse2Widen(acc, v);
+        }
+    }
+    uint64_t sum = sse2Total(acc);
+    if (W == 1)
+        sum -= 128 * (uint64_t)i;
+    return (int64_t)(sum + scalarSum<W>(src + i, (bytes - i) / W));
+}
+
+template <int W> int64_t sse2Dot(const uint8_t *a, const uint8_t *b, size_t count) {
+    static_assert(W < 4, "32-bit SSE2 dot products use scalarDot");
+    size_t bytes = count * W, i = 0;
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        if constexpr (W == 1) {
+            // Sign-extend to 16 bits, then PMADDWD sums pairs into 32 bits
+            __m128i xl = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+            __m128i xh = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+            __m128i yl = _mm_srai_epi16(_mm_unpacklo_epi8(y, y), 8);
+            __m128i yh = _mm_srai_epi16(_mm_unpackhi_epi8(y, y), 8);
+            acc = sse2Widen(acc, _mm_add_epi32(_mm_madd_epi16(xl, yl), _mm_madd_epi16(xh, yh)));
+        } else {
+            // PMADDWD overflows for two -32768 * -32768 pairs, so widen the
+            // full 32-bit products instead
+            __m128i lo = _mm_mullo_epi16(x, y);
+            __m128i hi = _mm_mulhi_epi16(x, y);
+            acc = sse2Widen(acc, _mm_unpacklo_epi16(lo, hi));
+            acc = sse2Widen(acc, _mm_unpackhi_epi16(lo, hi));
+        }
+    }
+    return (int64_t)((uint64_t)sse2Total(acc) + scalarDot<W>(a + i, b + i, (bytes - i) / W));
+}
+
+// SSE2 has no signed 32x32->64 multiply, building one is slower than IMUL
+template <> int64_t sse2Dot<4>(const uint8_t *a, const uint8_t *b, size_t count) {
+    return scalarDot<4>(a, b, count);
+}
+
+// AVX2 kernels, 32 bytes at a time. The 256-bit unpacks work per 128-bit
+// half, which the reductions do not care about.
+
+template <VectorOp Op, int W> MASM_AVX2 inline __m256i avx2Apply(__m256i a, __m256i b) {
+    if constexpr (Op == VectorOp::ADD) {
+        if constexpr (W == 1) return _mm256_add_epi8(a, b);
+        else if constexpr (W == 2) return _mm256_add_epi16(a, b);
+        else return _mm256_add_epi32(a, b);
+    } else if constexpr (Op == VectorOp::SUB) {
+        if constexpr (W == 1) return _mm256_sub_epi8(a, b);
+        else if constexpr (W == 2) return _mm256_sub_epi16(a, b);
+        else return _mm256_sub_epi32(a, b);
+    } else if constexpr (Op == VectorOp::MUL) {
+        if constexpr (W == 1) {
+            __m256i even = _mm256_mullo_epi16(a, b);
+            __m256i odd = _mm256_mullo_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+            return _mm256_or_si256(_mm256_and_si256(even, _mm256_set1_epi16(0xFF)),
+                                   _mm256_slli_epi16(odd, 8));
+        } else if constexpr (W == 2) {
+            return _mm256_mullo_epi16(a, b);
+        } else {
+            return _mm256_mullo_epi32(a, b);
+        }
+    } else if constexpr (Op == VectorOp::MIN) {
+        if constexpr (W == 1) return _mm256_min_epi8(a, b);
+        else if constexpr (W == 2) return _mm256_min_epi16(a, b);
+        else return _mm256_min_epi32(a, b);
+    } else {
+        if constexpr (W == 1) return _mm256_max_epi8(a, b);
+        else if constexpr (W == 2) return _mm256_max_epi16(a, b);
+        else return _mm256_max_epi32(a, b);
+    }
+}
+
+MASM_AVX2 inline __m256i avx2Widen(__m256i acc, __m256i v) {
+    __m256i sign = _mm256_cmpgt_epi32(_mm256_setzero_si256(), v);
+    acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(v, sign));
+    return _mm256_add_epi64(acc, _mm256_unpackhi_epi32(v, sign));
+}
+
+MASM_AVX2 inline int64_t avx2Total(__m256i acc) {
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    return (int64_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+template <VectorOp Op, int W> MASM_AVX2 void avx2Binary(uint8_t *dest, const uint8_t *src, size_t count) {
+    size_t bytes = count * W, i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(dest + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dest + i), avx2Apply<Op, W>(a, b));
+    }
+    scalarBinary<Op, W>(dest + i, src + i, (bytes - i) / W);
+}
+
+template <int W> MASM_AVX2 int64_t avx2Sum(const uint8_t *src, size_t count) {
+    size_t bytes = count * W, i = 0;
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        if constexpr (W == 1) {
+            __m256i biased = _mm256_xor_si256(v, _mm256_set1_epi8((char)0x80));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(biased, _mm256_setzero_si256()));
+        } else if constexpr (W == 2) {
+            acc = avx2Widen(acc, _mm256_madd_epi16(v, _mm256_set1_epi16(1)));
+        } else {
+            acc = avx2Widen(acc, v);
+        }
+    }
+    uint64_t sum = avx2Total(acc);
+    if (W == 1)
+        sum -= 128 * (uint64_t)i;
+    return (int64_t)(sum + scalarSum<W>(src + i, (bytes - i) / W));
+}
+
+template <int W> MASM_AVX2 int64_t avx2Dot(const uint8_t *a, const uint8_t *b, size_t count) {
+    size_t bytes = count * W, i = 0;
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        if constexpr (W == 1) {
+            __m256i xl = _mm256_srai_epi16(_mm256_unpacklo_epi8(x, x), 8);
+            __m256i xh = _mm256_srai_epi16(_mm256_unpackhi_epi8(x, x), 8);
+            __m256i yl = _mm256_srai_epi16(_mm256_unpacklo_epi8(y, y), 8);
+            __m256i yh = _mm256_srai_epi16(_mm256_unpackhi_epi8(y, y), 8);
+            acc = avx2Widen(acc, _mm256_add_epi32(_mm256_madd_epi16(xl, yl),
+                                                  _mm256_madd_epi16(xh, yh)));
+        } else if constexpr (W == 2) {
+            __m256i lo = _mm256_mullo_epi16(x, y);
+            __m256i hi = _mm256_mulhi_epi16(x, y);
+            acc = avx2Widen(acc, _mm256_unpacklo_epi16(lo, hi));
+            acc = avx2Widen(acc, _mm256_unpackhi_epi16(lo, hi));
+        } else {
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(x, y));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(_mm256_srli_epi64(x, 32),
+                                                         _mm256_srli_epi64(y, 32)));
+        }
+    }
+    return (int64_t)((uint64_t)avx2Total(acc) + scalarDot<W>(a + i, b + i, (bytes - i) / W));
+}
+
+#endif // MASM_USE_SIMD
+
+using BinaryKernel = void (*)(uint8_t *, const uint8_t *, size_t);
+using SumKernel = int64_t (*)(const uint8_t *, size_t);
+using DotKernel = int64_t (*)(const uint8_t *, const uint8_t *, size_t);
+
+// One ISA's kernels, indexed by VectorOp and by log2 of the element width
+struct Kernels {
+    BinaryKernel binary[5][3];
+    SumKernel sum[3];
+    DotKernel dot[3];
+};
+
+#define MASM_VECTOR_BINARY(isa, op) {isa##Binary<op, 1>, isa##Binary<op, 2>, isa##Binary<op, 4>}
+#define MASM_VECTOR_KERNELS(isa)                                               \
+    {{MASM_VECTOR_BINARY(isa, VectorOp::ADD), MASM_VECTOR_BINARY(isa, VectorOp::SUB), \
+      MASM_VECTOR_BINARY(isa, VectorOp::MUL), MASM_VECTOR_BINARY(isa, VectorOp::MIN), \
+      MASM_VECTOR_BINARY(isa, VectorOp::MAX)},                                 \
+     {isa##Sum<1>, isa##Sum<2>, isa##Sum<4>},                                  \
+     {isa##Dot<1>, isa##Dot<2>, isa##Dot<4>}}
+
+const Kernels scalarKernels = MASM_VECTOR_KERNELS(scalar);
+#if MASM_USE_SIMD
+const Kernels sse2Kernels = MASM_VECTOR_KERNELS(sse2);
+const Kernels avx2Kernels = MASM_VECTOR_KERNELS(avx2);
+#endif
+
+const Kernels &kernelsFor(VectorIsa isa) {
+#if MASM_USE_SIMD
+    if (isa == VectorIsa::AVX2)
+        return avx2Kernels;
+    if (isa == VectorIsa::SSE2)
+        return sse2Kernels;
+#endif
+    (void)isa;
+    return scalarKernels;
+}
+
+struct Selection {
+    VectorIsa isa = detectVectorIsa();
+    const Kernels *kernels = &kernelsFor(isa);
+};
+
+Selection &selection() {
+    static Selection active;
+    return active;
+}
+
+int widthIndex(int width) {
+    return width == 1 ? 0 : width == 2 ? 1 : 2;
+}
+
+} // namespace
+
+VectorIsa detectVectorIsa() {
+#if MASM_USE_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return VectorIsa::AVX2;
+    return VectorIsa::SSE2;
+#else
+    return VectorIsa::SCALAR;
+#endif
+}
+
+VectorIsa vectorIsa() {
+    return selection().isa;
+}
+
+void setVectorIsa(VectorIsa isa) {
+    if (isa > detectVectorIsa())
+        isa = detectVectorIsa();
+    selection().isa = isa;
+    selection().kernels = &kernelsFor(isa);
+}
+
+const char *vectorIsaName(VectorIsa isa) {
+    switch (isa) {
+    case VectorIsa::AVX2:
+        return "avx2";
+    case VectorIsa::SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+void vectorBinary(VectorOp op, int width, uint8_t *dest, const uint8_t *src, size_t count) {
+    // A destination that starts inside the source would read elements the
+    // SIMD loop has already overwritten, element by element order needs the
+    // scalar kernel
+    const Kernels &kernels = dest > src && dest < src + count * width
+                                 ? scalarKernels
+                                 : *selection().kernels;
+    kernels.binary[(int)op][widthIndex(width)](dest, src, count);
+}
+
+int64_t vectorSum(int width, const uint8_t *src, size_t count) {
+    return selection().kernels->sum[widthIndex(width)](src, count);
+}
+
+int64_t vectorDot(int width, const uint8_t *a, const uint8_t *b, size_t count) {
+    return selection().kernels->dot[widthIndex(width)](a, b, count);
+}
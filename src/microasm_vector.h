@@ -0,0 +1,35 @@
+// Masm vector kernels
+
+// Element-wise arithmetic and reductions over RAM ranges of signed 8, 16 and
+// 32-bit elements, behind the VADD..VDOT instructions. Each operation has a
+// scalar, an SSE2 and an AVX2 kernel; the widest one the CPU supports is
+// picked the first time a kernel runs.
+#ifndef MICROASM_VECTOR_H
+#define MICROASM_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+enum class VectorOp : uint8_t { ADD, SUB, MUL, MIN, MAX };
+
+enum class VectorIsa : uint8_t { SCALAR, SSE2, AVX2 };
+
+// The widest kernels this CPU can run
+VectorIsa detectVectorIsa();
+// The kernels vector instructions run with, detectVectorIsa() unless set
+VectorIsa vectorIsa();
+// Select the kernels, e.g. to compare them. An ISA the CPU lacks is replaced
+// by detectVectorIsa().
+void setVectorIsa(VectorIsa isa);
+const char *vectorIsaName(VectorIsa isa);
+
+// dest[i] = dest[i] op src[i] for `count` elements of `width` (1, 2 or 4)
+// bytes. ADD, SUB and MUL wrap; MIN and MAX compare signed. Overlapping
+// ranges give the same result as updating one element at a time in order.
+void vectorBinary(VectorOp op, int width, uint8_t *dest, const uint8_t *src, size_t count);
+// Sum of `count` signed elements, wrapping at 64 bits
+int64_t vectorSum(int width, const uint8_t *src, size_t count);
+// Sum of a[i] * b[i] over `count` signed elements, wrapping at 64 bits
+int64_t vectorDot(int width, const uint8_t *a, const uint8_t *b, size_t count);
+
+#endif // MICROASM_VECTOR_H
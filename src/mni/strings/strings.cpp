@@ -20,6 +20,6 @@ void StringMniRegister() {
             std::cout << s1 << std::endl
                       << s2 << std::endl
                       << std::to_string(s1 == s2);
-            machine.zeroFlag = (s1 == s2);
+            machine.setZeroFlag(s1 == s2);
         });
 }
@@ -0,0 +1,272 @@
+// C API checks for tests/run_tests.py, on programs that leave their results
+// in registers and RAM instead of printing them.
+//
+// Usage: masm_api_test budget <file.bin> <budget>
+//   Runs the program with masm_run_for(budget) until it halts and compares
+//   registers, flags and RAM with one masm_execute of the same program.
+//        masm_api_test clone <file.bin> <budget>
+//   Clones an interpreter suspended after one step of `budget`, runs both
+//   to the end in alternating steps and compares each with masm_execute.
+//   Then checks that running clones does not change the interpreter they
+//   were cloned from, and that writing to it does not change its clones.
+//        masm_api_test heaps <file.bin> <budget>
+//   Runs two interpreters with different sizes in RAX in alternating steps,
+//   so their MALLOC and FREE interleave, and compares each with one
+//   masm_execute of its own. Then prints the addresses each left at
+//   HEAP_TABLE. Both halts print their own unfreed chunks.
+//        masm_api_test ram <file.bin> <ram bytes>
+//   Creates an interpreter with that much RAM, runs the program in it and
+//   in a clone of it, and checks that the process grew by far less than the
+//   RAM, i.e. that untouched RAM pages were never written or read.
+//
+// Prints what it checked and exits with 1 on the first difference.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+
+#include "microasm_capi.h"
+
+static const int RAM_SIZE = 65536;
+// How much a ram run may grow the process, whatever the RAM size
+static const long RAM_TOUCHED_LIMIT = 16 << 20;
+// Where two_heaps.masm stores the chunks it leaves allocated
+static const int HEAP_TABLE = 60000;
+static const int HEAP_ROUNDS = 4;
+
+static MasmInterpreterHandle load(const char* file) {
+    MasmInterpreterHandle handle = masm_create_interpreter(RAM_SIZE, 0);
+    if (handle == nullptr || masm_load_bytecode(handle, file) != MASM_OK) {
+        std::cerr << "Could not load " << file << ": " << masm_get_last_error() << "\n";
+        std::exit(1);
+    }
+    return handle;
+}
+
+static void check(MasmResult result, const char* what) {
+    if (result != MASM_OK) {
+        std::cerr << what << " failed: " << masm_get_last_error() << "\n";
+        std::exit(1);
+    }
+}
+
+// Runs in steps of `budget` until the program halts, returns how many steps it took
+static int runInSteps(MasmInterpreterHandle handle, uint64_t budget) {
+    MasmRunStatus status = MASM_STATUS_SUSPENDED;
+    int steps = 0;
+    while (status == MASM_STATUS_SUSPENDED) {
+        check(masm_run_for(handle, budget, &status), "masm_run_for");
+        steps++;
+    }
+    return steps;
+}
+
+// Empty if both interpreters hold the same registers, flags and RAM, else
+// the first difference
+static std::string compare(MasmInterpreterHandle a, MasmInterpreterHandle b) {
+    MasmRegisters ra, rb;
+    check(masm_get_registers(a, &ra), "masm_get_registers");
+    check(masm_get_registers(b, &rb), "masm_get_registers");
+    if (std::memcmp(&ra, &rb, sizeof ra) != 0) return "registers differ";
+
+    int za, sa, zb, sb;
+    check(masm_get_flags(a, &za, &sa), "masm_get_flags");
+    check(masm_get_flags(b, &zb, &sb), "masm_get_flags");
+    if (za != zb || sa != sb) return "flags differ";
+
+    for (int address = 0; address < RAM_SIZE; address += 4) {
+        int32_t va, vb;
+        check(masm_read_ram_int(a, address, &va), "masm_read_ram_int");
+        check(masm_read_ram_int(b, address, &vb), "masm_read_ram_int");
+        if (va != vb) return "RAM differs at " + std::to_string(address);
+    }
+    return "";
+}
+
+// Loads file with RAX set to step
+static MasmInterpreterHandle loadWithStep(const char* file, int64_t step) {
+    MasmInterpreterHandle handle = load(file);
+    MasmRegisters registers;
+    check(masm_get_registers(handle, &registers), "masm_get_registers");
+    registers.rax = step;
+    check(masm_set_registers(handle, &registers), "masm_set_registers");
+    return handle;
+}
+
+static int budget(const char* file, uint64_t budget) {
+    MasmInterpreterHandle whole = load(file);
+    check(masm_execute(whole, 0, nullptr), "masm_execute");
+
+    MasmInterpreterHandle stepped = load(file);
+    int steps = runInSteps(stepped, budget);
+    std::string difference = compare(whole, stepped);
+
+    masm_destroy_interpreter(whole);
+    masm_destroy_interpreter(stepped);
+    if (difference != "") {
+        std::cout << "Resumed run: " << difference << "\n";
+        return 1;
+    }
+    std::cout << (steps > 1 ? "Suspended" : "Not suspended") << ", resumed run matches masm_execute\n";
+    return steps > 1 ? 0 : 1;
+}
+
+static int clone(const char* file, uint64_t budget) {
+    MasmInterpreterHandle whole = load(file);
+    check(masm_execute(whole, 0, nullptr), "masm_execute");
+
+    // A suspended interpreter and its clone, run side by side
+    MasmInterpreterHandle original = load(file);
+    MasmRunStatus status;
+    check(masm_run_for(original, budget, &status), "masm_run_for");
+    if (status != MASM_STATUS_SUSPENDED) {
+        std::cout << "Not suspended after one step\n";
+        return 1;
+    }
+    MasmInterpreterHandle copy = masm_clone_interpreter(original);
+    if (copy == nullptr) {
+        std::cerr << "masm_clone_interpreter failed: " << masm_get_last_error() << "\n";
+        return 1;
+    }
+    MasmRunStatus copyStatus = MASM_STATUS_SUSPENDED;
+    while (status == MASM_STATUS_SUSPENDED || copyStatus == MASM_STATUS_SUSPENDED) {
+        if (status == MASM_STATUS_SUSPENDED)
+            check(masm_run_for(original, budget, &status), "masm_run_for");
+        if (copyStatus == MASM_STATUS_SUSPENDED)
+            check(masm_run_for(copy, budget, &copyStatus), "masm_run_for");
+    }
+    std::string difference = compare(whole, original);
+    if (difference != "") {
+        std::cout << "Suspended original: " << difference << "\n";
+        return 1;
+    }
+    difference = compare(whole, copy);
+    if (difference != "") {
+        std::cout << "Clone of a suspended interpreter: " << difference << "\n";
+        return 1;
+    }
+    std::cout << "Suspended clone and original both match masm_execute\n";
+    masm_destroy_interpreter(original);
+    masm_destroy_interpreter(copy);
+
+    // Clones of a loaded interpreter and the interpreter itself
+    MasmInterpreterHandle fresh = load(file);
+    MasmInterpreterHandle loaded = load(file);
+    MasmInterpreterHandle first = masm_clone_interpreter(loaded);
+    MasmInterpreterHandle second = masm_clone_interpreter(loaded);
+    if (first == nullptr || second == nullptr) {
+        std::cerr << "masm_clone_interpreter failed: " << masm_get_last_error() << "\n";
+        return 1;
+    }
+    check(masm_execute(first, 0, nullptr), "masm_execute");
+    difference = compare(fresh, loaded);
+    if (difference != "") {
+        std::cout << "Running a clone changed the original: " << difference << "\n";
+        return 1;
+    }
+    for (int address = 0; address < RAM_SIZE; address += 4)
+        check(masm_write_ram_int(loaded, address, -1), "masm_write_ram_int");
+    check(masm_execute(second, 0, nullptr), "masm_execute");
+    difference = compare(whole, second);
+    if (difference != "") {
+        std::cout << "Writing the original changed a clone: " << difference << "\n";
+        return 1;
+    }
+    std::cout << "Clones and the original do not see each other's writes\n";
+
+    masm_destroy_interpreter(whole);
+    masm_destroy_interpreter(fresh);
+    masm_destroy_interpreter(loaded);
+    masm_destroy_interpreter(first);
+    masm_destroy_interpreter(second);
+    return 0;
+}
+
+static int heaps(const char* file, uint64_t budget) {
+    const int64_t steps[2] = {8, 24};
+    MasmInterpreterHandle alone[2], both[2];
+    for (int i = 0; i < 2; i++) {
+        std::cout << "Heap " << i + 1 << " alone:\n";
+        alone[i] = loadWithStep(file, steps[i]);
+        check(masm_execute(alone[i], 0, nullptr), "masm_execute");
+    }
+
+    std::cout << "Both heaps:\n";
+    MasmRunStatus status[2] = {MASM_STATUS_SUSPENDED, MASM_STATUS_SUSPENDED};
+    for (int i = 0; i < 2; i++)
+        both[i] = loadWithStep(file, steps[i]);
+    while (status[0] == MASM_STATUS_SUSPENDED || status[1] == MASM_STATUS_SUSPENDED) {
+        for (int i = 0; i < 2; i++) {
+            if (status[i] == MASM_STATUS_SUSPENDED)
+                check(masm_run_for(both[i], budget, &status[i]), "masm_run_for");
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        std::string difference = compare(alone[i], both[i]);
+        if (difference != "") {
+            std::cout << "Heap " << i + 1 << " next to another: " << difference << "\n";
+            return 1;
+        }
+        std::cout << "Heap " << i + 1 << " left";
+        for (int round = 0; round < HEAP_ROUNDS; round++) {
+            int32_t address;
+            check(masm_read_ram_int(both[i], HEAP_TABLE + 4 * round, &address), "masm_read_ram_int");
+            std::cout << " " << address;
+        }
+        std::cout << "\n";
+        masm_destroy_interpreter(alone[i]);
+        masm_destroy_interpreter(both[i]);
+    }
+    return 0;
+}
+
+// Peak resident size of this process in bytes
+static long peakResident() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss * 1024L;
+}
+
+static int ram(const char* file, uint64_t ramBytes) {
+    long before = peakResident();
+    MasmInterpreterHandle handle = masm_create_interpreter((int)ramBytes, 0);
+    if (handle == nullptr || masm_load_bytecode(handle, file) != MASM_OK) {
+        std::cerr << "Could not load " << file << ": " << masm_get_last_error() << "\n";
+        return 1;
+    }
+    MasmInterpreterHandle copy = masm_clone_interpreter(handle);
+    if (copy == nullptr) {
+        std::cerr << "masm_clone_interpreter failed: " << masm_get_last_error() << "\n";
+        return 1;
+    }
+    check(masm_execute(handle, 0, nullptr), "masm_execute");
+    check(masm_execute(copy, 0, nullptr), "masm_execute");
+    long grown = peakResident() - before;
+    masm_destroy_interpreter(handle);
+    masm_destroy_interpreter(copy);
+
+    if (grown >= RAM_TOUCHED_LIMIT) {
+        std::cout << (ramBytes >> 20) << " MiB of RAM grew the process by " << (grown >> 20) << " MiB\n";
+        return 1;
+    }
+    std::cout << (ramBytes >> 20) << " MiB of RAM and a clone of it left untouched\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (argc != 4 || (mode != "budget" && mode != "clone" && mode != "heaps" && mode != "ram")) {
+        std::cerr << "Usage: masm_api_test budget|clone|heaps|ram <file.bin> <budget>\n";
+        return 1;
+    }
+    uint64_t steps = std::strtoull(argv[3], nullptr, 10);
+    if (mode == "heaps")
+        return heaps(argv[2], steps);
+    if (mode == "ram")
+        return ram(argv[2], steps);
+    return mode == "budget" ? budget(argv[2], steps) : clone(argv[2], steps);
+}
@@ -3,4 +3,6 @@
 cd "../build"
 cmake --build . || exit $?
 cd ../tests
-cp ../build/masm tmp
\ No newline at end of file
+cp ../build/masm tmp
+cp ../build/masm_api_test tmp
+cp ../build/masm_masked tmp
\ No newline at end of file
@@ -30,6 +30,12 @@ def exit_code(stdout, stderr, proc, params, test):
 def stdout_test(stdout, stderr, proc, params, test):
     return params[0] == stdout.decode("utf-8")
 
+def stdout_contains(stdout, stderr, proc, params, test):
+    return params[0] in stdout.decode("utf-8", "replace")
+
+def stderr_contains(stdout, stderr, proc, params, test):
+    return params[0] in stderr.decode("utf-8", "replace")
+
 def file(stdout, stderr, proc, params, test):
     try:
         f1 = params[0]
@@ -40,12 +46,12 @@ def file(stdout, stderr, proc, params, test):
     except Exception as e:
         return False
 
-def car(prgm, output): #compile_and_run
+def car(prgm, output, modes=[[]], compile_flags=[], stderr=[]): #compile_and_run, one run per list of extra -i flags in modes, stderr must contain each string in stderr
     ret = [{
             "name": f"compile {prgm}.masm",
             "type": "COMPILING",
             "id": -1,
-            "cmd": ["%masm%", "-c", f"%data%/{prgm}.masm", f"%tmp%/{prgm}.bin"],
+            "cmd": ["%masm%", "-c", f"%data%/{prgm}.masm", f"%tmp%/{prgm}.bin"] + compile_flags,
             "depends": [0],
             "result": [
                 {
@@ -60,13 +66,14 @@ def car(prgm, output): #compile_and_run
                     "run": ["%masm%", "-u", f"%tmp%/{prgm}.bin"]
                 }
             ]
-        },
-        {
-            "name": f"run {prgm}.masm",
+        }]
+    for i, mode in enumerate(modes):
+        ret.append({
+            "name": " ".join([f"run {prgm}.masm"] + mode),
             "type": "RUNNING",
-            "id": -2,
+            "id": -2 - i,
             "depends": [-1],
-            "cmd": ["%masm%", "-i", f"%tmp%/{prgm}.bin"],
+            "cmd": ["%masm%", "-i", f"%tmp%/{prgm}.bin"] + mode,
             "result": [
                 {
                     "err":"Masm returned non 0 exit code. See Above",
@@ -78,8 +85,164 @@ def car(prgm, output): #compile_and_run
                     "check": "Tstdout",
                     "args": [output]
                 }
+            ] + [
+                {
+                    "err": f"Expected {text} in stderr",
+                    "check": "Tstderr_contains",
+                    "args": [text]
+                } for text in stderr
+            ]
+        })
+    return ret
+
+def unverified(prgm, output, fault, reason): # a program verifyProgram() rejects must run the same checked, with and without -d
+    binary = f"%tmp%/{prgm}.bin"
+    ret = []
+    if os.path.exists(f"{vars['data']}/{prgm}.bin"): # hand-made bytecode the compiler would not produce
+        binary = f"%data%/{prgm}.bin"
+    else:
+        ret.append({
+            "name": f"compile {prgm}.masm",
+            "type": "COMPILING",
+            "id": -1,
+            "cmd": ["%masm%", "-c", f"%data%/{prgm}.masm", binary],
+            "depends": [0],
+            "result": [
+                {
+                    "err":"Masm -c returned non 0 exit code. See Above",
+                    "check": "Texit_code",
+                    "args":[0]
+                }
+            ]
+        })
+    ret += [{
+            "name": f"run unverified {prgm}",
+            "type": "RUNNING",
+            "id": -2,
+            "depends": [-1] if ret else [0],
+            "cmd": ["%masm%", "-i", binary],
+            "result": [
+                {
+                    "err":"Masm should fail with exit code 1. See Above",
+                    "check": "Texit_code",
+                    "args":[1]
+                },
+                {
+                    "err": f"Expected {output} in stdout, instead got %stdout%",
+                    "check": "Tstdout",
+                    "args": [output]
+                },
+                {
+                    "err": f"Expected the checked loop to fail with {fault}",
+                    "check": "Tstderr_contains",
+                    "args": [f"Execution failed: {fault}"]
+                }
+            ]
+        },
+        {
+            "name": f"debug unverified {prgm}",
+            "type": "RUNNING",
+            "id": -3,
+            "depends": [-1] if ret else [0],
+            "cmd": ["%masm%", "-i", binary, "-d"],
+            "stdin": "c\n",
+            "result": [
+                {
+                    "err":"Masm -d should fail with exit code 1. See Above",
+                    "check": "Texit_code",
+                    "args":[1]
+                },
+                {
+                    "err": f"Expected the verifier to reject it with {reason}",
+                    "check": "Tstdout_contains",
+                    "args": [f"Not verified, running with checks: {reason}"]
+                },
+                {
+                    "err": f"Expected -d to fail with {fault} too",
+                    "check": "Tstderr_contains",
+                    "args": [f"Execution failed: {fault}"]
+                }
+            ]
+        }]
+    return ret
+
+def fails(prgm, output, fault, modes=[[]], compile_flags=[], interpreter="%masm%"): # a program that must stop with fault, one run per list of extra -i flags in modes
+    ret = [{
+            "name": f"compile {prgm}.masm",
+            "type": "COMPILING",
+            "id": -1,
+            "cmd": ["%masm%", "-c", f"%data%/{prgm}.masm", f"%tmp%/{prgm}.bin"] + compile_flags,
+            "depends": [0],
+            "result": [
+                {
+                    "err":"Masm -c returned non 0 exit code. See Above",
+                    "check": "Texit_code",
+                    "args":[0]
+                }
+            ]
+        }]
+    for i, mode in enumerate(modes):
+        ret.append({
+            "name": " ".join([f"run failing {prgm}.masm"] + mode),
+            "type": "RUNNING",
+            "id": -2 - i,
+            "depends": [-1],
+            "cmd": [interpreter, "-i", f"%tmp%/{prgm}.bin"] + mode,
+            "result": [
+                {
+                    "err":"Masm should fail with exit code 1. See Above",
+                    "check": "Texit_code",
+                    "args":[1]
+                },
+                {
+                    "err": f"Expected {output} in stdout, instead got %stdout%",
+                    "check": "Tstdout",
+                    "args": [output]
+                },
+                {
+                    "err": f"Expected it to fail with {fault}",
+                    "check": "Tstderr_contains",
+                    "args": [f"Execution failed: {fault}"]
+                }
+            ]
+        })
+    return ret
+
+def api(mode, prgm, budgets, output): # masm_api_test <mode> on prgm once per budget
+    ret = [{
+            "name": f"compile {prgm}.masm for the C API",
+            "type": "COMPILING",
+            "id": -1,
+            "cmd": ["%masm%", "-c", f"%data%/{prgm}.masm", f"%tmp%/{prgm}.api.bin"],
+            "depends": [0],
+            "result": [
+                {
+                    "err":"Masm -c returned non 0 exit code. See Above",
+                    "check": "Texit_code",
+                    "args":[0]
+                }
             ]
         }]
+    for i, budget in enumerate(budgets):
+        ret.append({
+            "name": f"C API {mode} {prgm} {budget}",
+            "type": "RUNNING",
+            "id": -2 - i,
+            "depends": [-1],
+            "cmd": ["%api%", mode, f"%tmp%/{prgm}.api.bin", str(budget)],
+            "result": [
+                {
+                    "err":"masm_api_test returned non 0 exit code. See Above",
+                    "check": "Texit_code",
+                    "args":[0]
+                },
+                {
+                    "err": f"Expected {output} in stdout, instead got %stdout%",
+                    "check": "Tstdout",
+                    "args": [output]
+                }
+            ]
+        })
     return ret
 
 completed_tests = []
@@ -88,10 +251,15 @@ checks = {
     "exit_code": exit_code,
     "file": file,
     "stdout": stdout_test,
+    "stdout_contains": stdout_contains,
+    "stderr_contains": stderr_contains,
 }
 
 macros = {
-    "compile_and_run": car
+    "compile_and_run": car,
+    "unverified": unverified,
+    "fails": fails,
+    "api": api
 }
 
 vars = {
@@ -117,6 +285,7 @@ def run_test(test: dict):
     result: dict = test.get("result", "NONE")
 
     depends: list = test.get("depends", []) # optional
+    stdin:   str  = test.get("stdin", "")      # optional
 
     if name == "NONE":
         failed(id, f"No name")
@@ -149,15 +318,12 @@ def run_test(test: dict):
             failed(name, "Depends on failed test")
             return 0
     
-    proc = subprocess.Popen([parse(i) for i in cmd], stderr=subprocess.PIPE, stdout=subprocess.PIPE)
+    proc = subprocess.Popen([parse(i) for i in cmd], stdin=subprocess.PIPE, stderr=subprocess.PIPE, stdout=subprocess.PIPE)
 
-    proc.wait()
+    stdout_text, stderr_text = proc.communicate(stdin.encode("utf-8"))
 
     passed = True
 
-    stdout_text = proc.stdout.read()
-    stderr_text = proc.stderr.read()
-
     for i in result:
         res = checks[i["check"][1:]](stdout_text, stderr_text, proc, [parse(a) for a in i["args"]], test)
         if (not res and i["check"][0] == "T") or (res and i["check"][0] == "F"):